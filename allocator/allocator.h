@@ -11,21 +11,100 @@
 #define _MY_ALLOCATOR_H_
 
 #include <new> // bad_alloc, new
-#include <cassert> // assert
 #include <cmath> // abs
 #include <stdexcept> // invalid_argument
 #include <cstddef> // ptrdiff_t, size_t
+#include <cstdint> // int64_t, uint64_t
+#include <cstdio> // FILE, fprintf, printf
+#include <vector> // vector
 
 #define EXTRA_SPACE_THRESHOLD 1
+/*
+ * Number of blocks of the request's own size class that SEGREGATED_FIT
+ * inspects before falling back to the head of a larger class.
+ */
+#define SEGREGATED_PROBES 8
+/* Default number of operations between two full walks in INTEGRITY_SAMPLED. */
+#define INTEGRITY_SAMPLE_PERIOD 1024
 
 static const int64_t sentinel_size = sizeof(int64_t);
 static const int64_t sentinels_size = sentinel_size << 1;
+static const int64_t size_classes = 64;
+static const int64_t nil_offset = -1;
 
-template <int64_t N>
+/*
+ * How the allocator manages 'mem'. The first two policies are general purpose
+ * and differ in how allocate() finds a free block:
+ *  - FIRST_FIT, the default, walks every block starting at mem[0];
+ *    O(blocks) per call.
+ *  - SEGREGATED_FIT keeps free blocks in per size-class lists (one class
+ *    per power of two), plus a bitmap of non-empty classes; O(1) for any
+ *    request that can be served from a larger class. Every block must be
+ *    able to hold its free-list links, so requests are rounded up to a
+ *    multiple of 8 bytes and at least 'min_free_block' bytes.
+ * The other two have no per-block sentinels:
+ *  - MONOTONIC bumps a pointer through 'mem'. deallocate() does nothing;
+ *    memory is only given back, all at once, by reset().
+ *  - POOL serves objects of at most S bytes from fixed-size slots, keeping
+ *    released slots in an intrusive free list.
+ */
+enum alloc_policy {
+    FIRST_FIT,
+    SEGREGATED_FIT,
+    MONOTONIC,
+    POOL
+};
+
+/*
+ * How much heap validation is done by allocate(), deallocate(), construct()
+ * and destroy(). Each level includes the checks of the previous ones.
+ *  - INTEGRITY_NONE does nothing.
+ *  - INTEGRITY_LOCAL checks the sentinels of the touched block and of its
+ *    neighbours; O(1).
+ *  - INTEGRITY_SAMPLED also walks the whole arena every K operations.
+ *  - INTEGRITY_FULL walks the whole arena on every operation; O(blocks).
+ * Detected corruptions are counted rather than asserted on, so checked builds
+ * can run under real load; see corruptions(). check_heap() walks the arena on
+ * demand regardless of the level.
+ */
+enum integrity_level {
+    INTEGRITY_NONE,
+    INTEGRITY_LOCAL,
+    INTEGRITY_SAMPLED,
+    INTEGRITY_FULL
+};
+
+/*
+ * Usage statistics of an allocator, as returned by allocator::stats(). The
+ * counters are updated on every call at the cost of a few additions; the
+ * fields marked as computed are only worked out when stats() is called.
+ */
+struct allocator_stats {
+    int64_t allocations; // Successful allocate() calls.
+    int64_t failed_allocations; // allocate() calls that returned null.
+    int64_t last_failed_request; // Size of the last failed request.
+    int64_t deallocations; // Blocks given back through deallocate().
+    int64_t live_blocks; // Blocks currently handed out.
+    int64_t peak_live_blocks;
+    int64_t used_bytes; // Bytes currently handed out, including padding.
+    int64_t peak_used_bytes;
+    int64_t size_histogram[size_classes]; // Requests by floor(log2(size)).
+    int64_t free_bytes; // Computed: bytes that could still be handed out.
+    int64_t largest_free_block; // Computed: biggest single request possible.
+    /*
+     * Computed: 1 - largest_free_block / free_bytes. Close to 1 when there is
+     * plenty of free memory but only in pieces too small to be useful.
+     */
+    double fragmentation;
+};
+
+template <int64_t N, alloc_policy P = FIRST_FIT, int64_t S = 0>
 class allocator {
+    static_assert(P != POOL || S > 0, "POOL needs the object size S.");
 public:
-    friend bool operator==(const allocator&, const allocator&) {
-        return false;
+    /* Memory from one arena can only be released to that same arena */
+    friend bool operator==(const allocator& lhs, const allocator& rhs) {
+        return &lhs == &rhs;
     }
     friend bool operator!=(const allocator& lhs, const allocator& rhs) {
         return !(lhs == rhs);
@@ -38,9 +117,19 @@ public:
     allocator &operator=(const allocator&) = default;
     /* Public functions */
     void* allocate(int64_t size);
+    void* allocate(int64_t size, int64_t alignment);
+    template<typename T> T* allocate(int64_t n);
     template<typename T> void construct(T* ptr, const T& value);
     void deallocate(void* ptr);
+    template<typename T> void deallocate(T* ptr, int64_t n);
     template<typename T> void destroy(T* ptr);
+    void reset();
+    void set_integrity(integrity_level level,
+                       int64_t sample_period = INTEGRITY_SAMPLE_PERIOD);
+    bool check_heap();
+    int64_t corruptions() const;
+    allocator_stats stats() const;
+    void dump(FILE* out = stdout) const;
 
 private:
     /* Data Members */
@@ -49,19 +138,57 @@ private:
      * memory to its user. It holds enough memory to allocate N instances of
      * type T.
      */
-    char mem[N];
+    alignas(sentinel_size) char mem[N];
     int64_t bytes_allocated; // Total number of bytes used by the allocator.
     int64_t blocks_count; // Number of blocks that 'mem' has been divided into.
     int64_t used_bytes; // Number of bytes that are currently in use.
     int64_t free_bytes; // Number of unused bytes left.
     bool verbose;
-    /* TODO: use a heap to keep track of the largest free block */
+    integrity_level integrity;
+    int64_t sample_period; // Operations between full walks when sampling.
+    int64_t operations; // Operations since the last sampled full walk.
+    int64_t corruption_count; // Corruptions detected so far.
+    allocator_stats counters; // Only the non-computed fields are kept.
+    /*
+     * Segregated free lists (SEGREGATED_FIT only). Blocks are referred to
+     * by the offset of their leading sentinel within 'mem', so copies of
+     * the allocator remain consistent. A free block stores the offsets of
+     * the next and previous blocks of its class right after its sentinel.
+     */
+    int64_t free_heads[size_classes];
+    uint64_t nonempty_classes; // Bit i is set iff free_heads[i] is not nil.
+    static const int64_t min_free_block = sentinels_size;
+    /* MONOTONIC and POOL: offset of the first byte never handed out */
+    int64_t top;
+    /* POOL: offset of the first released slot; slots are linked by offset */
+    int64_t pool_head;
+    static const int64_t pool_slot =
+        ((S > sentinel_size ? S : sentinel_size) + sentinel_size - 1) &
+        ~(sentinel_size - 1);
 
     /* Helper functions */
+    static bool boundary_tags();
+    void* bump_allocate(int64_t bytes, int64_t alignment);
+    void* pool_allocate(int64_t bytes, int64_t alignment);
+    void pool_deallocate(void* ptr);
+    void note_allocation(int64_t bytes);
+    void note_deallocation(int64_t bytes);
+    int64_t largest_free_block() const;
+    int64_t request_size(int64_t bytes) const;
+    int64_t lead_size(void* ptr, int64_t alignment) const;
+    bool fits(void* ptr, int64_t bytes, int64_t alignment) const;
+    void* find_first_fit(int64_t bytes, int64_t alignment);
+    void* find_segregated_fit(int64_t bytes, int64_t alignment);
+    static int64_t size_class(int64_t bytes);
+    int64_t* free_links(int64_t offset);
+    void free_list_insert(void* ptr);
+    void free_list_remove(void* ptr);
     void write_sentinel(void* ptr, int64_t value);
     void* shift_pointer(void* ptr, int64_t bytes) const;
     bool within_boundaries(void* ptr) const;
     bool valid_block(void* ptr, bool inverse = false) const;
+    bool valid_neighbourhood(void* ptr) const;
+    void check_integrity(void* ptr);
     bool valid();
 };
 
@@ -71,27 +198,41 @@ private:
  *************************
  */
 
-template<int64_t N>
-allocator<N>::allocator() :
+template<int64_t N, alloc_policy P, int64_t S>
+allocator<N, P, S>::allocator() :
     bytes_allocated(N),
-    blocks_count(1),
-    free_bytes(bytes_allocated - sentinels_size),
-    verbose(false)
+    verbose(false),
+#ifdef NDEBUG
+    integrity(INTEGRITY_NONE),
+#else
+    integrity(INTEGRITY_LOCAL),
+#endif
+    sample_period(INTEGRITY_SAMPLE_PERIOD),
+    operations(0),
+    corruption_count(0),
+    counters()
 {
-    write_sentinel(mem, free_bytes);
+    reset();
     if(!valid()) {
         throw std::bad_alloc();
     }
 }
 
-template<int64_t N>
-allocator<N>::allocator(bool _verbose) :
+template<int64_t N, alloc_policy P, int64_t S>
+allocator<N, P, S>::allocator(bool _verbose) :
     bytes_allocated(N),
-    blocks_count(1),
-    free_bytes(bytes_allocated - sentinels_size),
-    verbose(_verbose)
+    verbose(_verbose),
+#ifdef NDEBUG
+    integrity(INTEGRITY_NONE),
+#else
+    integrity(INTEGRITY_LOCAL),
+#endif
+    sample_period(INTEGRITY_SAMPLE_PERIOD),
+    operations(0),
+    corruption_count(0),
+    counters()
 {
-    write_sentinel(mem, free_bytes);
+    reset();
     if(!valid()) {
         throw std::bad_alloc();
     }
@@ -103,18 +244,34 @@ allocator<N>::allocator(bool _verbose) :
  **************************
  */
 
-template<int64_t N>
+template<int64_t N, alloc_policy P, int64_t S>
 bool
-allocator<N>::valid()
+allocator<N, P, S>::valid()
 {
     bool is_valid = true;
     void* ptr = reinterpret_cast<void*>(&mem[0]);
+    if (P == MONOTONIC) {
+        return top >= 0 && top <= bytes_allocated;
+    }
+    if (P == POOL) {
+        /* Every released slot must lie below 'top', with no cycles */
+        int64_t offset = pool_head;
+        for (int64_t slots = top / pool_slot; offset != nil_offset; --slots) {
+            if (slots == 0 || offset < 0 || offset >= top ||
+                offset % pool_slot) {
+                return false;
+            }
+            offset = *reinterpret_cast<int64_t*>(&mem[offset]);
+        }
+        return top >= 0 && top <= bytes_allocated;
+    }
     if (verbose) printf("Verifying that the memory is valid.\n");
     while (within_boundaries(ptr)) {
         int64_t block_size = *reinterpret_cast<int64_t*>(ptr);
         if (verbose) printf("  [0x%p]--(%lld-bytes)--", ptr, block_size);
         ptr = shift_pointer(ptr, abs(block_size) + sentinel_size);
-        if (block_size != *reinterpret_cast<int64_t*>(ptr)) {
+        if (!within_boundaries(ptr) ||
+            block_size != *reinterpret_cast<int64_t*>(ptr)) {
             if (verbose) printf("Broken sentinel\n");
             is_valid = false;
             break;
@@ -131,62 +288,134 @@ allocator<N>::valid()
  * beginning of the block of memory is returned. If there is not enough memory,
  * then a null pointer will be returned.
  */
-template<int64_t N>
+template<int64_t N, alloc_policy P, int64_t S>
 void*
-allocator<N>::allocate(int64_t M)
+allocator<N, P, S>::allocate(int64_t M)
 {
-    int64_t bytes_needed = M;
-    void* ptr = reinterpret_cast<void*>(&mem[0]);
+    return allocate(M, P == FIRST_FIT ? 1 : sentinel_size);
+}
+
+/*
+ * Same as allocate(M), but the returned pointer is a multiple of 'alignment',
+ * which must be a power of two. When the start of the chosen free block is
+ * not suitably aligned, the bytes before the aligned address are split off
+ * into a free block of their own.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+void*
+allocator<N, P, S>::allocate(int64_t M, int64_t alignment)
+{
+    int64_t bytes_needed = request_size(M);
+    void* ptr;
     void* result = NULL;
     
+    if (alignment <= 0 || (alignment & (alignment - 1))) {
+        throw std::invalid_argument("Alignment must be a power of two.");
+    }
+    ++counters.size_histogram[M > 1 ? size_class(M) : 0];
+    if (!boundary_tags()) {
+        result = P == MONOTONIC ? bump_allocate(M, alignment) :
+                                  pool_allocate(M, alignment);
+        if (!result) {
+            ++counters.failed_allocations;
+            counters.last_failed_request = M;
+        }
+        check_integrity(NULL);
+        return result;
+    }
     if (bytes_needed > free_bytes) {
         if (verbose) printf("Not enough space for %lld bytes.\n", M);
+        ++counters.failed_allocations;
+        counters.last_failed_request = M;
         return NULL;
     }
     if (verbose) printf("Allocating %lld bytes.\n", M);
 
-    while (within_boundaries(ptr) && !result) {
-        int64_t* l_ptr = reinterpret_cast<int64_t*>(ptr);
-        int64_t bytes_in_block = *l_ptr;
-        if (bytes_in_block < bytes_needed) {
-            ptr = shift_pointer(ptr, abs(bytes_in_block) + sentinels_size);
+    ptr = P == SEGREGATED_FIT ? find_segregated_fit(bytes_needed, alignment) :
+                                find_first_fit(bytes_needed, alignment);
+    if (ptr) {
+        int64_t bytes_in_block = *reinterpret_cast<int64_t*>(ptr);
+        int64_t lead = lead_size(ptr, alignment);
+        int64_t extra_bytes;
+        if (P == SEGREGATED_FIT) {
+            free_list_remove(ptr);
+        }
+
+        /* Split off the misaligned head of the block as a free block */
+        if (lead > 0) {
+            write_sentinel(ptr, lead - sentinels_size);
+            if (P == SEGREGATED_FIT) {
+                free_list_insert(ptr);
+            }
+            ++blocks_count;
+            free_bytes -= sentinels_size;
+            ptr = shift_pointer(ptr, lead);
+            bytes_in_block -= lead;
+            write_sentinel(ptr, bytes_in_block);
+        }
+
+        extra_bytes = bytes_in_block - bytes_needed;
+        /* Need to account for sentinels used for the extra space block */
+        extra_bytes -= sentinels_size;
+        result = shift_pointer(ptr, sentinel_size);
+
+        /* Use the whole block if there's not enough extra space */
+        if (extra_bytes < EXTRA_SPACE_THRESHOLD ||
+            (P == SEGREGATED_FIT && extra_bytes < min_free_block)) {
+            write_sentinel(ptr, -bytes_in_block);
+            free_bytes -= bytes_in_block;
         } else {
-            int64_t extra_bytes = bytes_in_block - bytes_needed;
-            /* Need to account for sentinels used for the extra space block */
-            extra_bytes -= sentinels_size;
-            result = shift_pointer(ptr, sentinel_size);
-            
-            /* Use the whole block if there's not enough extra space */
-            if (extra_bytes < EXTRA_SPACE_THRESHOLD) {
-                write_sentinel(ptr, -bytes_in_block);
-                free_bytes -= bytes_in_block;
-            } else {
-                /* Set sentinel for newly allocated space */
-                write_sentinel(ptr, -bytes_needed);
-                ptr = shift_pointer(ptr, bytes_needed + sentinels_size);
-                free_bytes -= bytes_needed;
-                ++blocks_count;
-                /* Set sentinel for extra space that's still unused */
-                write_sentinel(ptr, extra_bytes);
-                free_bytes -= sentinels_size;
+            /* Set sentinel for newly allocated space */
+            write_sentinel(ptr, -bytes_needed);
+            ptr = shift_pointer(ptr, bytes_needed + sentinels_size);
+            free_bytes -= bytes_needed;
+            ++blocks_count;
+            /* Set sentinel for extra space that's still unused */
+            write_sentinel(ptr, extra_bytes);
+            free_bytes -= sentinels_size;
+            if (P == SEGREGATED_FIT) {
+                free_list_insert(ptr);
             }
         }
     }
 
-    assert(valid());
+    if (result) {
+        note_allocation(abs(*reinterpret_cast<int64_t*>(
+            shift_pointer(result, -sentinel_size))));
+    } else {
+        ++counters.failed_allocations;
+        counters.last_failed_request = M;
+    }
+    check_integrity(result ? shift_pointer(result, -sentinel_size) : NULL);
     return result;
 }
 
-template<int64_t N>
+/*
+ * Allocates uninitialized memory for 'n' objects of type T, aligned for T.
+ * Returns a null pointer if there is not enough memory.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+template<typename T>
+T*
+allocator<N, P, S>::allocate(int64_t n)
+{
+    if (n < 0 || n > (N / static_cast<int64_t>(sizeof(T)))) {
+        return NULL;
+    }
+    return reinterpret_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+}
+
+template<int64_t N, alloc_policy P, int64_t S>
 template<typename T>
 void
-allocator<N>::
+allocator<N, P, S>::
 construct(T* ptr,
           const T& value)
 {
     T* t_ptr = reinterpret_cast<T*>(ptr);
     new (t_ptr) T(value);
-    assert(valid());
+    /* The block's metadata is not touched; this only counts as an operation */
+    check_integrity(NULL);
 }
 
 /*
@@ -194,13 +423,21 @@ construct(T* ptr,
  * The pointer provided must point to the same address that was returned by
  * allocate().
  */
-template<int64_t N>
+template<int64_t N, alloc_policy P, int64_t S>
 void
-allocator<N>::deallocate(void* p)
+allocator<N, P, S>::deallocate(void* p)
 {
     void *ptr, *previous_ptr, *next_ptr;
     int64_t block_size, prev_blk_size, next_blk_size;
 
+    if (!boundary_tags()) {
+        /* MONOTONIC memory is only released by reset() */
+        if (P == POOL) {
+            pool_deallocate(p);
+        }
+        check_integrity(NULL);
+        return;
+    }
     ptr = p;
     ptr = shift_pointer(ptr, -sentinel_size);
     
@@ -219,11 +456,16 @@ allocator<N>::deallocate(void* p)
     block_size = abs(block_size);
     if (verbose) printf("Deallocating %lld bytes.\n", block_size);
     free_bytes += block_size;
+    note_deallocation(block_size);
 
     /* Coalesce with the previous block, if possible */
     previous_ptr = shift_pointer(ptr, -sentinel_size);
-    prev_blk_size = *reinterpret_cast<int64_t*>(previous_ptr);
-    if (valid_block(previous_ptr, true) && prev_blk_size > 0) {
+    if (valid_block(previous_ptr, true) &&
+        (prev_blk_size = *reinterpret_cast<int64_t*>(previous_ptr)) > 0) {
+        if (P == SEGREGATED_FIT) {
+            free_list_remove(shift_pointer(previous_ptr,
+                                           -(prev_blk_size + sentinel_size)));
+        }
         ptr = shift_pointer(ptr, -(prev_blk_size + sentinels_size));
         block_size += prev_blk_size + sentinels_size;
         free_bytes += sentinels_size;
@@ -232,8 +474,11 @@ allocator<N>::deallocate(void* p)
 
     /* Coalesce with the next block, if possible */
     next_ptr = shift_pointer(ptr, block_size + sentinels_size);
-    next_blk_size = *reinterpret_cast<int64_t*>(next_ptr);
-    if (valid_block(next_ptr) && next_blk_size > 0) {
+    if (valid_block(next_ptr) &&
+        (next_blk_size = *reinterpret_cast<int64_t*>(next_ptr)) > 0) {
+        if (P == SEGREGATED_FIT) {
+            free_list_remove(next_ptr);
+        }
         block_size += next_blk_size + sentinels_size;
         free_bytes += sentinels_size;
         --blocks_count;
@@ -241,16 +486,182 @@ allocator<N>::deallocate(void* p)
 
     /* Write sentinels for the newly freed memory */
     write_sentinel(ptr, block_size);
-    assert(valid());
+    if (P == SEGREGATED_FIT) {
+        free_list_insert(ptr);
+    }
+    check_integrity(ptr);
+}
+
+/* Releases memory returned by allocate<T>(n). */
+template<int64_t N, alloc_policy P, int64_t S>
+template<typename T>
+void
+allocator<N, P, S>::deallocate(T* ptr, int64_t)
+{
+    deallocate(reinterpret_cast<void*>(ptr));
 }
 
-template<int64_t N>
+template<int64_t N, alloc_policy P, int64_t S>
 template<typename T>
 void
-allocator<N>::destroy(T* ptr)
+allocator<N, P, S>::destroy(T* ptr)
 {
     ptr->~T();
-    assert(valid());
+    check_integrity(NULL);
+}
+
+/*
+ * Releases every block at once and returns the allocator to its initial
+ * state. This is the only way to reclaim memory in MONOTONIC mode.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+void
+allocator<N, P, S>::reset()
+{
+    for (int64_t i = 0; i < size_classes; ++i) {
+        free_heads[i] = nil_offset;
+    }
+    nonempty_classes = 0;
+    top = 0;
+    pool_head = nil_offset;
+    used_bytes = 0;
+    counters.live_blocks = 0;
+    counters.used_bytes = 0;
+    if (!boundary_tags()) {
+        blocks_count = 0;
+        free_bytes = P == POOL ? N / pool_slot * pool_slot : N;
+        return;
+    }
+    blocks_count = 1;
+    free_bytes = bytes_allocated - sentinels_size;
+    write_sentinel(mem, free_bytes);
+    if (P == SEGREGATED_FIT) {
+        free_list_insert(mem);
+    }
+}
+
+template<int64_t N, alloc_policy P, int64_t S>
+void
+allocator<N, P, S>::set_integrity(integrity_level level, int64_t period)
+{
+    integrity = level;
+    sample_period = period > 0 ? period : 1;
+    operations = 0;
+}
+
+/*
+ * Walks the whole arena and verifies every sentinel. Returns whether the heap
+ * is valid; a broken heap also counts as one corruption.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+bool
+allocator<N, P, S>::check_heap()
+{
+    bool is_valid = valid();
+    if (!is_valid) {
+        if (verbose) printf("Heap corruption detected.\n");
+        ++corruption_count;
+    }
+    return is_valid;
+}
+
+/* Number of corruptions detected so far by any integrity check. */
+template<int64_t N, alloc_policy P, int64_t S>
+int64_t
+allocator<N, P, S>::corruptions() const
+{
+    return corruption_count;
+}
+
+/*
+ * Returns the current usage statistics. Takes O(1) time except for finding
+ * the largest free block, which is O(free blocks of the largest class) for
+ * SEGREGATED_FIT and O(blocks) for FIRST_FIT.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+allocator_stats
+allocator<N, P, S>::stats() const
+{
+    allocator_stats result = counters;
+    result.free_bytes = free_bytes;
+    result.largest_free_block = largest_free_block();
+    result.fragmentation = free_bytes > 0 ?
+        1.0 - double(result.largest_free_block) / free_bytes : 0.0;
+    return result;
+}
+
+/*
+ * Writes the statistics and the map of every block in 'mem' as a single JSON
+ * object. Offsets and sizes are in bytes; for blocks delimited by sentinels
+ * they refer to the memory between the two sentinels.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+void
+allocator<N, P, S>::dump(FILE* out) const
+{
+    static const char* policy_names[] = {"FIRST_FIT", "SEGREGATED_FIT",
+                                         "MONOTONIC", "POOL"};
+    allocator_stats st = stats();
+    const char* separator = "";
+
+    fprintf(out, "{\"policy\":\"%s\",\"capacity\":%lld,", policy_names[P],
+            static_cast<long long>(N));
+    fprintf(out, "\"allocations\":%lld,\"failed_allocations\":%lld,"
+            "\"last_failed_request\":%lld,\"deallocations\":%lld,"
+            "\"live_blocks\":%lld,\"peak_live_blocks\":%lld,"
+            "\"used_bytes\":%lld,\"peak_used_bytes\":%lld,"
+            "\"free_bytes\":%lld,\"largest_free_block\":%lld,"
+            "\"fragmentation\":%.4f,\"size_histogram\":[",
+            static_cast<long long>(st.allocations),
+            static_cast<long long>(st.failed_allocations),
+            static_cast<long long>(st.last_failed_request),
+            static_cast<long long>(st.deallocations),
+            static_cast<long long>(st.live_blocks),
+            static_cast<long long>(st.peak_live_blocks),
+            static_cast<long long>(st.used_bytes),
+            static_cast<long long>(st.peak_used_bytes),
+            static_cast<long long>(st.free_bytes),
+            static_cast<long long>(st.largest_free_block), st.fragmentation);
+    for (int64_t i = 0; i < size_classes; ++i) {
+        fprintf(out, "%s%lld", i ? "," : "",
+                static_cast<long long>(st.size_histogram[i]));
+    }
+    fprintf(out, "],\"blocks\":[");
+    if (boundary_tags()) {
+        int64_t offset = 0;
+        while (offset + sentinels_size <= bytes_allocated) {
+            int64_t size = *reinterpret_cast<const int64_t*>(&mem[offset]);
+            fprintf(out, "%s{\"offset\":%lld,\"size\":%lld,\"free\":%s}",
+                    separator, static_cast<long long>(offset + sentinel_size),
+                    static_cast<long long>(abs(size)),
+                    size > 0 ? "true" : "false");
+            separator = ",";
+            offset += abs(size) + sentinels_size;
+        }
+    } else if (P == POOL) {
+        std::vector<bool> released(top / pool_slot);
+        for (int64_t offset = pool_head; offset != nil_offset;
+             offset = *reinterpret_cast<const int64_t*>(&mem[offset])) {
+            released[offset / pool_slot] = true;
+        }
+        for (int64_t slot = 0; slot < top / pool_slot; ++slot) {
+            fprintf(out, "%s{\"offset\":%lld,\"size\":%lld,\"free\":%s}",
+                    separator, static_cast<long long>(slot * pool_slot),
+                    static_cast<long long>(pool_slot),
+                    released[slot] ? "true" : "false");
+            separator = ",";
+        }
+    } else if (top > 0) {
+        fprintf(out, "{\"offset\":0,\"size\":%lld,\"free\":false}",
+                static_cast<long long>(top));
+        separator = ",";
+    }
+    if (!boundary_tags() && top < bytes_allocated) {
+        fprintf(out, "%s{\"offset\":%lld,\"size\":%lld,\"free\":true}",
+                separator, static_cast<long long>(top),
+                static_cast<long long>(bytes_allocated - top));
+    }
+    fprintf(out, "]}\n");
 }
 
 /*
@@ -259,9 +670,322 @@ allocator<N>::destroy(T* ptr)
  **************************
  */
 
-template<int64_t N>
+/* Updates the counters after handing out a block of the given size. */
+template<int64_t N, alloc_policy P, int64_t S>
+void
+allocator<N, P, S>::note_allocation(int64_t bytes)
+{
+    ++counters.allocations;
+    used_bytes += bytes;
+    counters.used_bytes = used_bytes;
+    if (used_bytes > counters.peak_used_bytes) {
+        counters.peak_used_bytes = used_bytes;
+    }
+    if (++counters.live_blocks > counters.peak_live_blocks) {
+        counters.peak_live_blocks = counters.live_blocks;
+    }
+}
+
+template<int64_t N, alloc_policy P, int64_t S>
 void
-allocator<N>::write_sentinel(void* ptr,
+allocator<N, P, S>::note_deallocation(int64_t bytes)
+{
+    ++counters.deallocations;
+    used_bytes -= bytes;
+    counters.used_bytes = used_bytes;
+    --counters.live_blocks;
+}
+
+/* Size of the biggest request that allocate() could serve right now. */
+template<int64_t N, alloc_policy P, int64_t S>
+int64_t
+allocator<N, P, S>::largest_free_block() const
+{
+    int64_t largest = 0;
+
+    if (P == MONOTONIC) {
+        return bytes_allocated - top;
+    }
+    if (P == POOL) {
+        return pool_head != nil_offset || top + pool_slot <= bytes_allocated ?
+               pool_slot : 0;
+    }
+    if (P == SEGREGATED_FIT) {
+        if (nonempty_classes) {
+            int64_t cls = 63 - __builtin_clzll(nonempty_classes);
+            for (int64_t offset = free_heads[cls]; offset != nil_offset;
+                 offset = *reinterpret_cast<const int64_t*>(
+                     &mem[offset + sentinel_size])) {
+                int64_t size = *reinterpret_cast<const int64_t*>(&mem[offset]);
+                largest = size > largest ? size : largest;
+            }
+        }
+        return largest;
+    }
+    for (int64_t offset = 0; offset + sentinels_size <= bytes_allocated;) {
+        int64_t size = *reinterpret_cast<const int64_t*>(&mem[offset]);
+        largest = size > largest ? size : largest;
+        offset += abs(size) + sentinels_size;
+    }
+    return largest;
+}
+
+/* Whether blocks are delimited by sentinels, i.e. FIRST_FIT or SEGREGATED_FIT */
+template<int64_t N, alloc_policy P, int64_t S>
+bool
+allocator<N, P, S>::boundary_tags()
+{
+    return P == FIRST_FIT || P == SEGREGATED_FIT;
+}
+
+/* MONOTONIC: hands out the next suitably aligned bytes after 'top'. */
+template<int64_t N, alloc_policy P, int64_t S>
+void*
+allocator<N, P, S>::bump_allocate(int64_t bytes, int64_t alignment)
+{
+    uintptr_t base = reinterpret_cast<uintptr_t>(&mem[0]);
+    int64_t start = ((base + top + alignment - 1) & ~(alignment - 1)) - base;
+
+    if (bytes < 0 || start + bytes > bytes_allocated) {
+        if (verbose) printf("Not enough space for %lld bytes.\n",
+                            static_cast<long long>(bytes));
+        return NULL;
+    }
+    ++blocks_count;
+    free_bytes -= start + bytes - top;
+    note_allocation(start + bytes - top);
+    top = start + bytes;
+    return &mem[start];
+}
+
+/*
+ * POOL: reuses the most recently released slot, or carves a new one after
+ * 'top'. Requests larger than a slot, or more aligned than one, fail.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+void*
+allocator<N, P, S>::pool_allocate(int64_t bytes, int64_t alignment)
+{
+    int64_t offset;
+
+    if (bytes > pool_slot || alignment > sentinel_size) {
+        if (verbose) printf("Pool slots cannot hold %lld bytes.\n",
+                            static_cast<long long>(bytes));
+        return NULL;
+    }
+    if (pool_head != nil_offset) {
+        offset = pool_head;
+        pool_head = *reinterpret_cast<int64_t*>(&mem[offset]);
+    } else if (top + pool_slot <= bytes_allocated) {
+        offset = top;
+        top += pool_slot;
+    } else {
+        if (verbose) printf("Pool is full.\n");
+        return NULL;
+    }
+    ++blocks_count;
+    free_bytes -= pool_slot;
+    note_allocation(pool_slot);
+    return &mem[offset];
+}
+
+template<int64_t N, alloc_policy P, int64_t S>
+void
+allocator<N, P, S>::pool_deallocate(void* ptr)
+{
+    int64_t offset = static_cast<char*>(ptr) - mem;
+
+    if (!within_boundaries(ptr) || offset >= top || offset % pool_slot) {
+        if (verbose) printf("Tried to deallocate an invalid address.\n");
+        throw std::invalid_argument("Tried to deallocate invalid address.");
+    }
+    *reinterpret_cast<int64_t*>(ptr) = pool_head;
+    pool_head = offset;
+    --blocks_count;
+    free_bytes += pool_slot;
+    note_deallocation(pool_slot);
+}
+
+/*
+ * Returns the number of bytes actually reserved for a request of the given
+ * size. SEGREGATED_FIT keeps blocks 8-byte aligned and large enough to hold
+ * their free-list links once they are released.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+int64_t
+allocator<N, P, S>::request_size(int64_t bytes) const
+{
+    if (P != SEGREGATED_FIT) {
+        return bytes;
+    }
+    bytes = (bytes + sentinel_size - 1) & ~(sentinel_size - 1);
+    return bytes < min_free_block ? min_free_block : bytes;
+}
+
+/*
+ * Number of bytes to skip from the start of the block at 'ptr' so that its
+ * memory begins at a multiple of 'alignment'. The skipped bytes must be able
+ * to form a free block of their own, so the result is either 0 or at least
+ * the size of the smallest block.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+int64_t
+allocator<N, P, S>::lead_size(void* ptr, int64_t alignment) const
+{
+    uintptr_t start = reinterpret_cast<uintptr_t>(ptr) + sentinel_size;
+    int64_t min_lead = sentinels_size + request_size(EXTRA_SPACE_THRESHOLD);
+    int64_t lead = (alignment - start % alignment) % alignment;
+
+    while (lead > 0 && lead < min_lead) {
+        lead += alignment;
+    }
+    return lead;
+}
+
+/* Whether the free block at 'ptr' can hold an aligned request. */
+template<int64_t N, alloc_policy P, int64_t S>
+bool
+allocator<N, P, S>::fits(void* ptr, int64_t bytes, int64_t alignment) const
+{
+    return *reinterpret_cast<int64_t*>(ptr) >=
+           bytes + lead_size(ptr, alignment);
+}
+
+/*
+ * Returns a pointer to the leading sentinel of the first free block that can
+ * hold the given number of bytes, or a null pointer if there is none.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+void*
+allocator<N, P, S>::find_first_fit(int64_t bytes, int64_t alignment)
+{
+    void* ptr = reinterpret_cast<void*>(&mem[0]);
+    while (within_boundaries(ptr)) {
+        int64_t bytes_in_block = *reinterpret_cast<int64_t*>(ptr);
+        if (bytes_in_block >= bytes && fits(ptr, bytes, alignment)) {
+            return ptr;
+        }
+        ptr = shift_pointer(ptr, abs(bytes_in_block) + sentinels_size);
+    }
+    return NULL;
+}
+
+/*
+ * Same as find_first_fit() but only looks at free blocks. The request's own
+ * size class may hold blocks that are too small, so only a few of them are
+ * probed before moving on to the larger non-empty classes, smallest first.
+ * Without alignment the head of the first one always fits; with it, the
+ * padding may not, so each class is walked until a block fits. The rest of
+ * the own class is scanned only as a last resort.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+void*
+allocator<N, P, S>::find_segregated_fit(int64_t bytes, int64_t alignment)
+{
+    int64_t cls = size_class(bytes);
+    int64_t offset = free_heads[cls];
+    uint64_t larger;
+
+    for (int probes = 0; offset != nil_offset && probes < SEGREGATED_PROBES;
+         ++probes, offset = free_links(offset)[0]) {
+        if (fits(&mem[offset], bytes, alignment)) {
+            return &mem[offset];
+        }
+    }
+    larger = cls + 1 < size_classes ? nonempty_classes >> (cls + 1) : 0;
+    while (larger) {
+        int64_t larger_cls = cls + 1 + __builtin_ctzll(larger);
+        for (int64_t candidate = free_heads[larger_cls];
+             candidate != nil_offset; candidate = free_links(candidate)[0]) {
+            if (fits(&mem[candidate], bytes, alignment)) {
+                return &mem[candidate];
+            }
+        }
+        larger &= larger - 1;
+    }
+    for (; offset != nil_offset; offset = free_links(offset)[0]) {
+        if (fits(&mem[offset], bytes, alignment)) {
+            return &mem[offset];
+        }
+    }
+    return NULL;
+}
+
+/* Size class of a block: floor(log2(bytes)). */
+template<int64_t N, alloc_policy P, int64_t S>
+int64_t
+allocator<N, P, S>::size_class(int64_t bytes)
+{
+    return 63 - __builtin_clzll(static_cast<uint64_t>(bytes));
+}
+
+/* Returns the {next, previous} links stored in the free block at 'offset'. */
+template<int64_t N, alloc_policy P, int64_t S>
+int64_t*
+allocator<N, P, S>::free_links(int64_t offset)
+{
+    return reinterpret_cast<int64_t*>(&mem[offset + sentinel_size]);
+}
+
+/*
+ * Pushes the free block whose leading sentinel is at 'ptr' onto the list of
+ * its size class. Blocks too small to hold the links are left out; they are
+ * picked up again when a neighbour is released and coalesces with them.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+void
+allocator<N, P, S>::free_list_insert(void* ptr)
+{
+    int64_t bytes = *reinterpret_cast<int64_t*>(ptr);
+    int64_t offset = static_cast<char*>(ptr) - mem;
+    int64_t cls;
+    int64_t* links;
+
+    if (bytes < min_free_block) {
+        return;
+    }
+    cls = size_class(bytes);
+    links = free_links(offset);
+    links[0] = free_heads[cls];
+    links[1] = nil_offset;
+    if (free_heads[cls] != nil_offset) {
+        free_links(free_heads[cls])[1] = offset;
+    }
+    free_heads[cls] = offset;
+    nonempty_classes |= uint64_t(1) << cls;
+}
+
+/* Unlinks the free block whose leading sentinel is at 'ptr'. */
+template<int64_t N, alloc_policy P, int64_t S>
+void
+allocator<N, P, S>::free_list_remove(void* ptr)
+{
+    int64_t bytes = *reinterpret_cast<int64_t*>(ptr);
+    int64_t offset = static_cast<char*>(ptr) - mem;
+    int64_t cls;
+    int64_t* links;
+
+    if (bytes < min_free_block) {
+        return;
+    }
+    cls = size_class(bytes);
+    links = free_links(offset);
+    if (links[1] != nil_offset) {
+        free_links(links[1])[0] = links[0];
+    } else {
+        free_heads[cls] = links[0];
+    }
+    if (links[0] != nil_offset) {
+        free_links(links[0])[1] = links[1];
+    }
+    if (free_heads[cls] == nil_offset) {
+        nonempty_classes &= ~(uint64_t(1) << cls);
+    }
+}
+
+template<int64_t N, alloc_policy P, int64_t S>
+void
+allocator<N, P, S>::write_sentinel(void* ptr,
                                int64_t size)
 {
     int64_t* l_ptr = reinterpret_cast<int64_t*>(ptr);
@@ -271,9 +995,9 @@ allocator<N>::write_sentinel(void* ptr,
     *l_ptr = size;
 }
 
-template<int64_t N>
+template<int64_t N, alloc_policy P, int64_t S>
 void*
-allocator<N>::shift_pointer(void* ptr,
+allocator<N, P, S>::shift_pointer(void* ptr,
                               int64_t shift) const
 {
     char *char_ptr = (char*) ptr;
@@ -282,17 +1006,60 @@ allocator<N>::shift_pointer(void* ptr,
     return ptr;
 }
 
-template<int64_t N>
+template<int64_t N, alloc_policy P, int64_t S>
 bool
-allocator<N>::within_boundaries(void *ptr) const
+allocator<N, P, S>::within_boundaries(void *ptr) const
 {
     return ptr && ptr >= &mem[0] &&
            ptr <= &mem[bytes_allocated - 1];
 }
 
-template<int64_t N>
+/*
+ * Runs the checks selected by 'integrity' after an operation that touched the
+ * block whose leading sentinel is at 'ptr'. A null pointer means that no
+ * block metadata was touched.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+void
+allocator<N, P, S>::check_integrity(void* ptr)
+{
+    if (integrity == INTEGRITY_NONE) {
+        return;
+    }
+    if (ptr && !valid_neighbourhood(ptr)) {
+        if (verbose) printf("Broken sentinel around [0x%p]\n", ptr);
+        ++corruption_count;
+    }
+    if (integrity == INTEGRITY_FULL ||
+        (integrity == INTEGRITY_SAMPLED && ++operations >= sample_period)) {
+        operations = 0;
+        check_heap();
+    }
+}
+
+/*
+ * Checks the sentinels of the block that starts at 'ptr' and of the blocks
+ * right before and after it.
+ */
+template<int64_t N, alloc_policy P, int64_t S>
+bool
+allocator<N, P, S>::valid_neighbourhood(void* ptr) const
+{
+    void* prev_ptr = shift_pointer(ptr, -sentinel_size);
+    void* next_ptr;
+
+    if (!valid_block(ptr)) {
+        return false;
+    }
+    next_ptr = shift_pointer(ptr, abs(*reinterpret_cast<int64_t*>(ptr)) +
+                                  sentinels_size);
+    return (!within_boundaries(prev_ptr) || valid_block(prev_ptr, true)) &&
+           (!within_boundaries(next_ptr) || valid_block(next_ptr));
+}
+
+template<int64_t N, alloc_policy P, int64_t S>
 bool
-allocator<N>::valid_block(void* ptr, bool inverse) const
+allocator<N, P, S>::valid_block(void* ptr, bool inverse) const
 {
     if (within_boundaries(ptr)) {
         int64_t blk_size = abs(*reinterpret_cast<int64_t*>(ptr));
@@ -306,4 +1073,56 @@ allocator<N>::valid_block(void* ptr, bool inverse) const
     return false;
 }
 
+/*
+ * Adaptor that lets standard containers take their memory from an
+ * allocator<N, P, S> arena instead of the global heap:
+ *
+ *     allocator<1 << 20> arena;
+ *     arena_allocator<int, 1 << 20> alloc(arena);
+ *     std::vector<int, arena_allocator<int, 1 << 20>> v(alloc);
+ *
+ * Copies, including rebound ones, share the arena and compare equal iff they
+ * use the same one. Throws bad_alloc when the arena is out of memory.
+ */
+template <typename T, int64_t N, alloc_policy P = FIRST_FIT,
+          int64_t S = 0>
+class arena_allocator {
+public:
+    typedef T value_type;
+    template <typename U>
+    struct rebind {
+        typedef arena_allocator<U, N, P, S> other;
+    };
+
+    arena_allocator(allocator<N, P, S>& _arena) : arena(&_arena) {}
+    template <typename U>
+    arena_allocator(const arena_allocator<U, N, P, S>& rhs) :
+        arena(rhs.arena) {}
+
+    T* allocate(size_t n) {
+        T* ptr = arena->template allocate<T>(n);
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+    void deallocate(T* ptr, size_t n) {
+        arena->deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const arena_allocator<U, N, P, S>& rhs) const {
+        return arena == rhs.arena;
+    }
+    template <typename U>
+    bool operator!=(const arena_allocator<U, N, P, S>& rhs) const {
+        return arena != rhs.arena;
+    }
+
+private:
+    template <typename, int64_t, alloc_policy, int64_t>
+    friend class arena_allocator;
+    allocator<N, P, S>* arena;
+};
+
 #endif /* _MY_ALLOCATOR_H_ */
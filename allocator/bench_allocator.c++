@@ -0,0 +1,110 @@
+/*
+ * Benchmark for the allocation policies of allocator<N>.
+ *  - The general-purpose policies fragment the arena with thousands of live
+ *    blocks and then run a random mix of allocate() and deallocate() calls.
+ *  - All policies then allocate batches of same-size objects and free each
+ *    batch at once, and report how many bytes of the arena each object uses.
+ *
+ * Build with -DNDEBUG so that no integrity checks are done; see
+ * integrity_level.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "allocator.h"
+
+#define ARENA_SIZE (8 << 20)
+#define LIVE_BLOCKS 10000
+#define OPERATIONS 100000
+#define MAX_REQUEST 256
+#define OBJECT_SIZE 24
+#define BATCH 100000
+#define BATCH_ROUNDS 20
+
+template<alloc_policy P>
+double
+run_bench(const char* name)
+{
+    allocator<ARENA_SIZE, P>* a = new allocator<ARENA_SIZE, P>();
+    std::vector<void*> live;
+    int64_t failed = 0;
+
+    std::srand(42);
+    /* Fill the arena, then free every other block to fragment it */
+    for (int i = 0; i < 2 * LIVE_BLOCKS; ++i) {
+        live.push_back(a->allocate(std::rand() % MAX_REQUEST + 1));
+    }
+    for (int i = 0; i < 2 * LIVE_BLOCKS; i += 2) {
+        a->deallocate(live[i]);
+        live[i] = NULL;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < OPERATIONS; ++i) {
+        void*& slot = live[std::rand() % live.size()];
+        if (slot) {
+            a->deallocate(slot);
+            slot = NULL;
+        } else if (!(slot = a->allocate(std::rand() % MAX_REQUEST + 1))) {
+            ++failed;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double secs = std::chrono::duration<double>(end - start).count();
+    printf("%-16s %10.0f ops/sec (%lld failed allocations)\n", name,
+           OPERATIONS / secs, static_cast<long long>(failed));
+    delete a;
+    return secs;
+}
+
+template<alloc_policy P>
+void
+run_batch_bench(const char* name)
+{
+    typedef allocator<ARENA_SIZE, P, OBJECT_SIZE> arena_t;
+    arena_t* a = new arena_t();
+    std::vector<void*> batch(BATCH);
+    int64_t objects = 0;
+
+    /* Memory overhead: fill the arena and see how many objects fit */
+    while (a->allocate(OBJECT_SIZE)) {
+        ++objects;
+    }
+    a->reset();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < BATCH_ROUNDS; ++round) {
+        for (int i = 0; i < BATCH; ++i) {
+            batch[i] = a->allocate(OBJECT_SIZE);
+        }
+        if (P == MONOTONIC) {
+            a->reset();
+        } else {
+            for (int i = 0; i < BATCH; ++i) {
+                a->deallocate(batch[i]);
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double secs = std::chrono::duration<double>(end - start).count();
+    printf("%-16s %10.0f ops/sec %6.1f bytes/object (%d-byte objects)\n",
+           name, 2.0 * BATCH * BATCH_ROUNDS / secs,
+           double(ARENA_SIZE) / objects, OBJECT_SIZE);
+    delete a;
+}
+
+int
+main (const int argc, const char** argv)
+{
+    double first_fit = run_bench<FIRST_FIT>("first-fit");
+    double segregated = run_bench<SEGREGATED_FIT>("segregated-fit");
+    printf("Speedup: %.1fx\n\n", first_fit / segregated);
+
+    run_batch_bench<SEGREGATED_FIT>("segregated-fit");
+    run_batch_bench<MONOTONIC>("monotonic");
+    run_batch_bench<POOL>("pool");
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Multi-threaded benchmark for concurrent_allocator<N>. Every thread
+ * allocates and frees small blocks; one in MAILBOX_PERIOD blocks is swapped
+ * through a shared mailbox so that it is freed by another thread. The same
+ * workload runs against allocator<N> behind a single mutex for comparison.
+ * Every block is written when it is allocated, so that the time includes
+ * bringing its memory into the cache.
+ *
+ * Build with -DNDEBUG so that no integrity checks are done.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "concurrent_allocator.h"
+
+#define ARENA_SIZE (64 << 20)
+#define MAX_THREADS 32
+#define OPS_PER_THREAD 200000
+#define LIVE_PER_THREAD 64
+#define MAX_REQUEST 256
+#define MAILBOXES 256
+#define MAILBOX_PERIOD 8
+
+/* allocator<N> made thread-safe by wrapping every call in a mutex. It uses
+ * the same policy as the central pool of concurrent_allocator<N>. */
+template <int64_t N>
+struct locked_allocator {
+    allocator<N, SEGREGATED_FIT> a;
+    std::mutex m;
+    void* allocate(int64_t size) {
+        std::lock_guard<std::mutex> guard(m);
+        return a.allocate(size);
+    }
+    void deallocate(void* ptr) {
+        std::lock_guard<std::mutex> guard(m);
+        a.deallocate(ptr);
+    }
+};
+
+std::atomic<void*> mailboxes[MAILBOXES];
+
+template <typename A>
+void
+run_thread(A* a, unsigned seed)
+{
+    void* live[LIVE_PER_THREAD] = {};
+    for (int i = 0; i < OPS_PER_THREAD; ++i) {
+        void*& slot = live[rand_r(&seed) % LIVE_PER_THREAD];
+        if (slot) {
+            if (i % MAILBOX_PERIOD == 0) {
+                slot = mailboxes[rand_r(&seed) % MAILBOXES].exchange(slot);
+            }
+            if (slot) {
+                a->deallocate(slot);
+            }
+        }
+        int64_t size = rand_r(&seed) % MAX_REQUEST + 1;
+        slot = a->allocate(size);
+        if (slot) {
+            memset(slot, i, size);
+        }
+    }
+    for (void* ptr : live) {
+        if (ptr) {
+            a->deallocate(ptr);
+        }
+    }
+}
+
+template <typename A>
+double
+run_bench(A* a, int num_threads)
+{
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_threads; ++i) {
+        threads.push_back(std::thread(run_thread<A>, a, i + 1));
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    for (std::atomic<void*>& mailbox : mailboxes) {
+        if (void* ptr = mailbox.exchange(NULL)) {
+            a->deallocate(ptr);
+        }
+    }
+    double secs = std::chrono::duration<double>(end - start).count();
+    return num_threads * double(OPS_PER_THREAD) / secs;
+}
+
+int
+main (const int argc, const char** argv)
+{
+    locked_allocator<ARENA_SIZE>* locked = new locked_allocator<ARENA_SIZE>();
+    concurrent_allocator<ARENA_SIZE>* cached =
+        new concurrent_allocator<ARENA_SIZE>();
+
+    printf("threads   mutex ops/sec  cached ops/sec  speedup\n");
+    for (int n = 1; n <= MAX_THREADS; n <<= 1) {
+        double mutex_ops = run_bench(locked, n);
+        double cached_ops = run_bench(cached, n);
+        printf("%7d %15.0f %15.0f %7.1fx\n", n, mutex_ops, cached_ops,
+               cached_ops / mutex_ops);
+    }
+
+    delete cached;
+    delete locked;
+    return 0;
+}
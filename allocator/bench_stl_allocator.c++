@@ -0,0 +1,99 @@
+/*
+ * Benchmark for arena_allocator. Runs the same container workloads with
+ * memory from an allocator<N> arena and from the default std::allocator.
+ *
+ * Build with -DNDEBUG so that no integrity checks are done.
+ */
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "allocator.h"
+
+#define ARENA_SIZE (64 << 20)
+#define ELEMENTS 200000
+#define ROUNDS 10
+
+typedef allocator<ARENA_SIZE, SEGREGATED_FIT> arena_t;
+
+template <typename T>
+using arena_alloc = arena_allocator<T, ARENA_SIZE, SEGREGATED_FIT>;
+
+template <typename Alloc>
+void
+vector_workload(const Alloc& alloc)
+{
+    std::vector<int, Alloc> v(alloc);
+    for (int i = 0; i < ELEMENTS; ++i) {
+        v.push_back(i);
+    }
+}
+
+template <typename Alloc>
+void
+list_workload(const Alloc& alloc)
+{
+    std::list<int, Alloc> l(alloc);
+    for (int i = 0; i < ELEMENTS; ++i) {
+        l.push_back(i);
+    }
+    while (!l.empty()) {
+        l.pop_front();
+    }
+}
+
+template <typename Alloc>
+void
+map_workload(const Alloc& alloc)
+{
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, Alloc>
+        m(16, std::hash<int>(), std::equal_to<int>(), alloc);
+    for (int i = 0; i < ELEMENTS; ++i) {
+        m[i] = i;
+    }
+    for (int i = 0; i < ELEMENTS; i += 2) {
+        m.erase(i);
+    }
+}
+
+double
+time_rounds(const std::function<void()>& workload)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        workload();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return ROUNDS * double(ELEMENTS) /
+           std::chrono::duration<double>(end - start).count();
+}
+
+void
+report(const char* name, double arena_ops, double default_ops)
+{
+    printf("%-14s %14.0f %14.0f %7.2fx\n", name, arena_ops, default_ops,
+           arena_ops / default_ops);
+}
+
+int
+main (const int argc, const char** argv)
+{
+    arena_t* arena = new arena_t();
+
+    printf("container      arena elem/s  default elem/s  speedup\n");
+    report("vector<int>",
+           time_rounds([&] { vector_workload(arena_alloc<int>(*arena)); }),
+           time_rounds([] { vector_workload(std::allocator<int>()); }));
+    report("list<int>",
+           time_rounds([&] { list_workload(arena_alloc<int>(*arena)); }),
+           time_rounds([] { list_workload(std::allocator<int>()); }));
+    typedef std::pair<const int, int> entry;
+    report("unordered_map",
+           time_rounds([&] { map_workload(arena_alloc<entry>(*arena)); }),
+           time_rounds([] { map_workload(std::allocator<entry>()); }));
+
+    delete arena;
+    return 0;
+}
@@ -0,0 +1,367 @@
+/*
+ * Thread-safe front-end for allocator<N>. Every thread gets a small cache of
+ * size-classed blocks carved from the shared arena; the central allocator is
+ * only locked to refill or flush a cache, one batch of blocks at a time.
+ * Requests larger than the biggest class go straight to the central pool.
+ *
+ * A block freed by a thread other than the one whose cache it came from is
+ * pushed onto a lock-free list owned by that cache, and the owner drains it
+ * the next time its cache for that class runs dry.
+ *
+ * Author: Ricardo Sanchez Aguilera
+ */
+
+#ifndef _MY_CONCURRENT_ALLOCATOR_H_
+#define _MY_CONCURRENT_ALLOCATOR_H_
+
+#include <atomic> // atomic
+#include <mutex> // mutex, lock_guard
+#include "allocator.h"
+
+/* Smallest cached class; class i holds blocks of CACHE_MIN_BLOCK << i bytes */
+#define CACHE_MIN_BLOCK 16
+#define CACHE_CLASSES 7
+/* Blocks moved between a thread cache and the central pool at once */
+#define CACHE_BATCH 32
+/* Threads that can hold a cache at the same time; others use the central pool */
+#define CACHE_MAX_THREADS 64
+
+/*
+ * Process-wide registry of cache slots. A thread claims the lowest free slot
+ * the first time it asks for one and gives it back when it exits, so the
+ * caches of an allocator are reused by later threads.
+ */
+class thread_slots {
+public:
+    static int id() {
+        static thread_local holder h;
+        return h.slot;
+    }
+
+private:
+    struct holder {
+        int slot;
+        holder() : slot(-1) {
+            uint64_t bits = used.load();
+            while (~bits) {
+                int free_slot = __builtin_ctzll(~bits);
+                if (used.compare_exchange_weak(bits,
+                                               bits | uint64_t(1) << free_slot)) {
+                    slot = free_slot;
+                    break;
+                }
+            }
+        }
+        ~holder() {
+            if (slot >= 0) {
+                used.fetch_and(~(uint64_t(1) << slot));
+            }
+        }
+    };
+    static std::atomic<uint64_t> used; // Bit i is set iff slot i is taken.
+};
+
+inline std::atomic<uint64_t> thread_slots::used(0);
+
+template <int64_t N>
+class concurrent_allocator {
+public:
+    /* Constructors & Destructors */
+    concurrent_allocator();
+    concurrent_allocator(const concurrent_allocator&) = delete;
+    ~concurrent_allocator() = default;
+    concurrent_allocator &operator=(const concurrent_allocator&) = delete;
+    /* Public functions */
+    void* allocate(int64_t size);
+    template<typename T> void construct(T* ptr, const T& value);
+    void deallocate(void* ptr);
+    template<typename T> void destroy(T* ptr);
+    void flush_cache();
+    allocator_stats stats();
+
+private:
+    /*
+     * Every block handed out starts with this header; the user gets the
+     * memory right after it. Uncached (large) blocks have a negative class.
+     */
+    struct block_header {
+        int32_t owner; // Slot of the cache the block belongs to.
+        int32_t cls; // Size class of the block.
+    };
+    /* Free blocks are linked through their first bytes after the header */
+    struct free_block {
+        free_block* next;
+    };
+    /*
+     * Per-thread cache. Only the owning thread touches 'lists' and 'counts';
+     * other threads only push onto 'remote'. Padded so that caches of
+     * different threads never share a cache line.
+     */
+    struct alignas(64) thread_cache {
+        free_block* lists[CACHE_CLASSES];
+        int64_t counts[CACHE_CLASSES];
+        std::atomic<free_block*> remote;
+        thread_cache() : lists(), counts(), remote(NULL) {}
+    };
+
+    /* Data Members */
+    allocator<N, SEGREGATED_FIT> central; // Guarded by 'central_lock'.
+    std::mutex central_lock;
+    thread_cache caches[CACHE_MAX_THREADS];
+
+    /* Helper functions */
+    static int size_class(int64_t bytes);
+    static int64_t class_size(int cls);
+    static block_header* header(void* ptr);
+    void* central_allocate(int64_t bytes, int32_t owner, int32_t cls);
+    void refill(thread_cache& cache, int slot, int cls);
+    void flush(thread_cache& cache, int cls);
+    void drain_remote(thread_cache& cache);
+    void push_local(thread_cache& cache, free_block* blk, int cls);
+};
+
+/*
+ *************************
+ ****** Constructor ******
+ *************************
+ */
+
+template<int64_t N>
+concurrent_allocator<N>::concurrent_allocator() :
+    central(),
+    central_lock(),
+    caches()
+{
+
+}
+
+/*
+ **************************
+ **** Public functions ****
+ **************************
+ */
+
+/*
+ * Allocates a contiguous block of memory of at least M-bytes. A pointer to the
+ * beginning of the block of memory is returned. If there is not enough memory,
+ * then a null pointer will be returned.
+ */
+template<int64_t N>
+void*
+concurrent_allocator<N>::allocate(int64_t M)
+{
+    int cls = size_class(M);
+    int slot = thread_slots::id();
+    if (cls < 0 || slot < 0) {
+        std::lock_guard<std::mutex> guard(central_lock);
+        return central_allocate(M, -1, -1);
+    }
+
+    thread_cache& cache = caches[slot];
+    if (!cache.lists[cls]) {
+        drain_remote(cache);
+        if (!cache.lists[cls]) {
+            refill(cache, slot, cls);
+            if (!cache.lists[cls]) {
+                return NULL;
+            }
+        }
+    }
+    free_block* blk = cache.lists[cls];
+    cache.lists[cls] = blk->next;
+    --cache.counts[cls];
+    return blk;
+}
+
+template<int64_t N>
+template<typename T>
+void
+concurrent_allocator<N>::construct(T* ptr,
+                                   const T& value)
+{
+    new (ptr) T(value);
+}
+
+/*
+ * Releases a block returned by allocate(). Blocks of the calling thread's own
+ * cache are kept in it; blocks of other caches are handed back to their owner
+ * without taking any lock.
+ */
+template<int64_t N>
+void
+concurrent_allocator<N>::deallocate(void* p)
+{
+    block_header* hdr = header(p);
+    free_block* blk = reinterpret_cast<free_block*>(p);
+    int slot;
+
+    if (hdr->cls < 0) {
+        std::lock_guard<std::mutex> guard(central_lock);
+        central.deallocate(hdr);
+        return;
+    }
+    slot = thread_slots::id();
+    if (slot == hdr->owner) {
+        push_local(caches[slot], blk, hdr->cls);
+        return;
+    }
+    std::atomic<free_block*>& remote = caches[hdr->owner].remote;
+    blk->next = remote.load(std::memory_order_relaxed);
+    while (!remote.compare_exchange_weak(blk->next, blk,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+    }
+}
+
+template<int64_t N>
+template<typename T>
+void
+concurrent_allocator<N>::destroy(T* ptr)
+{
+    ptr->~T();
+}
+
+/*
+ * Gives every block in the calling thread's cache back to the central pool,
+ * including those other threads have freed into it so far. Blocks freed into
+ * the cache afterwards stay there until its next refill or flush.
+ */
+template<int64_t N>
+void
+concurrent_allocator<N>::flush_cache()
+{
+    int slot = thread_slots::id();
+    if (slot < 0) {
+        return;
+    }
+    thread_cache& cache = caches[slot];
+    drain_remote(cache);
+    for (int cls = 0; cls < CACHE_CLASSES; ++cls) {
+        while (cache.lists[cls]) {
+            flush(cache, cls);
+        }
+    }
+}
+
+/*
+ * Statistics of the central pool. Blocks sitting in thread caches count as
+ * live there, so the numbers only match what the user holds once every
+ * thread has flushed its cache.
+ */
+template<int64_t N>
+allocator_stats
+concurrent_allocator<N>::stats()
+{
+    std::lock_guard<std::mutex> guard(central_lock);
+    return central.stats();
+}
+
+/*
+ **************************
+ **** Helper functions ****
+ **************************
+ */
+
+/* Smallest cached class that fits 'bytes', or -1 if none does. */
+template<int64_t N>
+int
+concurrent_allocator<N>::size_class(int64_t bytes)
+{
+    for (int cls = 0; cls < CACHE_CLASSES; ++cls) {
+        if (bytes <= class_size(cls)) {
+            return cls;
+        }
+    }
+    return -1;
+}
+
+template<int64_t N>
+int64_t
+concurrent_allocator<N>::class_size(int cls)
+{
+    return int64_t(CACHE_MIN_BLOCK) << cls;
+}
+
+template<int64_t N>
+typename concurrent_allocator<N>::block_header*
+concurrent_allocator<N>::header(void* ptr)
+{
+    return reinterpret_cast<block_header*>(ptr) - 1;
+}
+
+/* Must be called with 'central_lock' held. */
+template<int64_t N>
+void*
+concurrent_allocator<N>::central_allocate(int64_t bytes,
+                                          int32_t owner,
+                                          int32_t cls)
+{
+    block_header* hdr = reinterpret_cast<block_header*>(
+        central.allocate(bytes + sizeof(block_header)));
+    if (!hdr) {
+        return NULL;
+    }
+    hdr->owner = owner;
+    hdr->cls = cls;
+    return hdr + 1;
+}
+
+/* Moves up to CACHE_BATCH new blocks of class 'cls' into the cache. */
+template<int64_t N>
+void
+concurrent_allocator<N>::refill(thread_cache& cache, int slot, int cls)
+{
+    std::lock_guard<std::mutex> guard(central_lock);
+    for (int i = 0; i < CACHE_BATCH; ++i) {
+        free_block* blk = reinterpret_cast<free_block*>(
+            central_allocate(class_size(cls), slot, cls));
+        if (!blk) {
+            break;
+        }
+        blk->next = cache.lists[cls];
+        cache.lists[cls] = blk;
+        ++cache.counts[cls];
+    }
+}
+
+/* Returns CACHE_BATCH blocks of class 'cls' to the central pool. */
+template<int64_t N>
+void
+concurrent_allocator<N>::flush(thread_cache& cache, int cls)
+{
+    std::lock_guard<std::mutex> guard(central_lock);
+    for (int i = 0; i < CACHE_BATCH && cache.lists[cls]; ++i) {
+        free_block* blk = cache.lists[cls];
+        cache.lists[cls] = blk->next;
+        --cache.counts[cls];
+        central.deallocate(header(blk));
+    }
+}
+
+/* Moves every block freed by other threads back into the local lists. */
+template<int64_t N>
+void
+concurrent_allocator<N>::drain_remote(thread_cache& cache)
+{
+    free_block* blk = cache.remote.exchange(NULL, std::memory_order_acquire);
+    while (blk) {
+        free_block* next = blk->next;
+        push_local(cache, blk, header(blk)->cls);
+        blk = next;
+    }
+}
+
+template<int64_t N>
+void
+concurrent_allocator<N>::push_local(thread_cache& cache,
+                                    free_block* blk,
+                                    int cls)
+{
+    blk->next = cache.lists[cls];
+    cache.lists[cls] = blk;
+    if (++cache.counts[cls] > 2 * CACHE_BATCH) {
+        flush(cache, cls);
+    }
+}
+
+#endif /* _MY_CONCURRENT_ALLOCATOR_H_ */
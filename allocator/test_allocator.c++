@@ -1,5 +1,6 @@
 #include <iostream>
 #include <vector>
+#include <cstring>
 #include "allocator.h"
 
 typedef struct my_struct_s {
@@ -36,5 +37,96 @@ main (const int argc, const char** argv)
         std::cout << "Test passed.\n";
     }
 
+    // Every allocation of the loop above but the last one succeeded, and
+    // everything has been given back.
+    allocator_stats st = a.stats();
+    if (st.allocations != static_cast<int64_t>(v.size()) ||
+        st.failed_allocations != 1 || st.deallocations != st.allocations ||
+        st.live_blocks || st.used_bytes || !st.peak_used_bytes ||
+        st.largest_free_block != st.free_bytes || st.fragmentation != 0.0) {
+        std::cout << "Wrong statistics...\n";
+    } else {
+        std::cout << "Statistics test passed.\n";
+    }
+    a.dump();
+
+    // Overflow a block into its trailing sentinel and expect the local
+    // checks on its neighbour, and a full walk, to report it.
+    allocator<99> b;
+    b.set_integrity(INTEGRITY_LOCAL);
+    char *first = reinterpret_cast<char *>(b.allocate(16));
+    void *second = b.allocate(16);
+    memset(first, 0x7f, 16 + sizeof(int64_t));
+    b.deallocate(second);
+    if (b.check_heap() || b.corruptions() != 2) {
+        std::cout << "Corruption went undetected...\n";
+    } else {
+        std::cout << "Corruption test passed.\n";
+    }
+
+    // Aligned and typed allocations, including through an STL container.
+    allocator<4096> c;
+    void *aligned = c.allocate(40, 64);
+    double *doubles = c.allocate<double>(3);
+    std::vector<int, arena_allocator<int, 4096>> arena_vector(c);
+    for (int j = 0; j < 100; ++j) {
+        arena_vector.push_back(j);
+    }
+    if (reinterpret_cast<uintptr_t>(aligned) % 64 ||
+        reinterpret_cast<uintptr_t>(doubles) % alignof(double) ||
+        arena_vector[99] != 99 || c.corruptions()) {
+        std::cout << "Aligned allocation failed...\n";
+    } else {
+        std::cout << "Aligned allocation test passed.\n";
+    }
+    c.deallocate(aligned);
+    c.deallocate(doubles, 3);
+
+    // An aligned request fits a free block of a larger size class even
+    // when the block at the head of that class's list is misaligned.
+    allocator<4096, SEGREGATED_FIT> d;
+    std::vector<void *> blocks;
+    void *block;
+    while ((block = d.allocate(72)) && d.allocate(8)) {
+        blocks.push_back(block);
+    }
+    void *aligned_block = NULL, *misaligned_block = NULL;
+    for (void *b : blocks) {
+        bool on_boundary = reinterpret_cast<uintptr_t>(b) % 64 == 0;
+        if (on_boundary && !aligned_block) {
+            aligned_block = b;
+        } else if (!on_boundary) {
+            misaligned_block = b;
+        }
+    }
+    d.deallocate(aligned_block);
+    d.deallocate(misaligned_block);
+    if (d.allocate(48, 64) != aligned_block || d.corruptions()) {
+        std::cout << "Aligned segregated fit failed...\n";
+    } else {
+        std::cout << "Aligned segregated fit test passed.\n";
+    }
+
+    // Pool slots are reused after being released; a monotonic arena only
+    // gets its memory back on reset().
+    allocator<256, POOL, sizeof(my_struct_t)> pool;
+    allocator<256, MONOTONIC> bump;
+    int slots = 0;
+    void *slot = NULL;
+    while ((ptr = reinterpret_cast<my_struct_t *>(pool.allocate(sizeof(my_struct_t))))) {
+        slot = ptr;
+        ++slots;
+    }
+    pool.deallocate(slot);
+    void *first_bump = bump.allocate(200);
+    bool bump_full = !bump.allocate(100);
+    bump.reset();
+    if (slots != 256 / 8 || pool.allocate(sizeof(my_struct_t)) != slot ||
+        !bump_full || bump.allocate(100) != first_bump) {
+        std::cout << "Pool or monotonic allocation failed...\n";
+    } else {
+        std::cout << "Pool and monotonic test passed.\n";
+    }
+
     return 0;
 }
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "concurrent_allocator.h"
+
+#define ARENA_SIZE (16 << 20)
+#define THREADS 8
+#define ROUNDS 4
+#define OPS_PER_ROUND 20000
+#define LIVE_PER_THREAD 256
+#define MAX_REQUEST 1500
+#define MAILBOXES 64
+
+/* A block handed out by the allocator, stamped with a tag of its own. */
+struct stamped_block {
+    unsigned char* ptr;
+    int64_t size;
+    uint64_t tag;
+};
+
+/* Byte 'i' of the pattern of a block tagged 'tag'. */
+static unsigned char
+pattern(uint64_t tag, int64_t i)
+{
+    return static_cast<unsigned char>(
+        ((tag + i) * 0x9e3779b97f4a7c15ULL) >> 56);
+}
+
+static void
+stamp(const stamped_block& b)
+{
+    for (int64_t i = 0; i < b.size; ++i) {
+        b.ptr[i] = pattern(b.tag, i);
+    }
+}
+
+static bool
+intact(const stamped_block& b)
+{
+    for (int64_t i = 0; i < b.size; ++i) {
+        if (b.ptr[i] != pattern(b.tag, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef concurrent_allocator<ARENA_SIZE> arena_t;
+
+/* Blocks passed between threads, so that they are freed by a thread other
+ * than the one whose cache they came from. */
+std::atomic<stamped_block*> mailboxes[MAILBOXES];
+
+struct worker {
+    std::vector<stamped_block> live;
+    unsigned seed;
+    uint64_t sequence;
+    bool ok;
+};
+
+/* Allocates, frees and swaps blocks through the mailboxes at random; every
+ * block is stamped when allocated and checked when freed. */
+static void
+run_round(arena_t* a, worker* w, int id)
+{
+    for (int i = 0; i < OPS_PER_ROUND; ++i) {
+        int op = rand_r(&w->seed) % 3;
+        if (w->live.empty() ||
+            (op == 0 && w->live.size() < LIVE_PER_THREAD)) {
+            stamped_block b;
+            b.size = rand_r(&w->seed) % MAX_REQUEST + 1;
+            b.ptr = static_cast<unsigned char*>(a->allocate(b.size));
+            b.tag = (uint64_t(id) << 32) | w->sequence++;
+            if (!b.ptr) {
+                w->ok = false;
+                continue;
+            }
+            stamp(b);
+            w->live.push_back(b);
+            continue;
+        }
+        size_t k = rand_r(&w->seed) % w->live.size();
+        if (op != 2) {
+            w->ok = w->ok && intact(w->live[k]);
+            a->deallocate(w->live[k].ptr);
+            w->live[k] = w->live.back();
+            w->live.pop_back();
+        } else {
+            stamped_block* out = new stamped_block(w->live[k]);
+            stamped_block* in =
+                mailboxes[rand_r(&w->seed) % MAILBOXES].exchange(out);
+            if (in) {
+                w->live[k] = *in;
+                delete in;
+            } else {
+                w->live[k] = w->live.back();
+                w->live.pop_back();
+            }
+        }
+    }
+}
+
+/* Frees every block the worker holds, waits until all workers have, and
+ * then gives its cache back to the central pool. */
+static void
+finish(arena_t* a, worker* w, std::atomic<int>* freeing)
+{
+    for (const stamped_block& b : w->live) {
+        w->ok = w->ok && intact(b);
+        a->deallocate(b.ptr);
+    }
+    w->live.clear();
+    freeing->fetch_sub(1);
+    while (freeing->load() > 0) {
+        std::this_thread::yield();
+    }
+    a->flush_cache();
+}
+
+int
+main (const int argc, const char** argv)
+{
+    arena_t* a = new arena_t();
+    std::vector<worker> workers(THREADS);
+    bool ok = true;
+
+    for (int t = 0; t < THREADS; ++t) {
+        workers[t].seed = t + 1;
+        workers[t].sequence = 0;
+        workers[t].ok = true;
+    }
+
+    // After every round, the blocks still held by the workers and the
+    // mailboxes must be pairwise disjoint and keep their stamps.
+    for (int round = 0; round < ROUNDS; ++round) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.push_back(std::thread(run_round, a, &workers[t], t));
+        }
+        for (std::thread& th : threads) {
+            th.join();
+        }
+        std::vector<stamped_block> live;
+        for (const worker& w : workers) {
+            ok = ok && w.ok;
+            live.insert(live.end(), w.live.begin(), w.live.end());
+        }
+        for (std::atomic<stamped_block*>& mailbox : mailboxes) {
+            if (stamped_block* b = mailbox.load()) {
+                live.push_back(*b);
+            }
+        }
+        std::sort(live.begin(), live.end(),
+                  [](const stamped_block& x, const stamped_block& y) {
+                      return x.ptr < y.ptr;
+                  });
+        for (size_t i = 0; i < live.size(); ++i) {
+            ok = ok && intact(live[i]) &&
+                 (i == 0 || live[i - 1].ptr + live[i - 1].size <= live[i].ptr);
+        }
+    }
+    if (!ok) {
+        std::cout << "Blocks overlap or were overwritten...\n";
+    } else {
+        std::cout << "Concurrent allocation test passed.\n";
+    }
+
+    // Every block is freed, and once the caches are flushed the central
+    // allocator holds nothing.
+    for (std::atomic<stamped_block*>& mailbox : mailboxes) {
+        if (stamped_block* b = mailbox.exchange(NULL)) {
+            ok = ok && intact(*b);
+            a->deallocate(b->ptr);
+            delete b;
+        }
+    }
+    std::atomic<int> freeing(THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.push_back(std::thread(finish, a, &workers[t], &freeing));
+    }
+    for (std::thread& th : threads) {
+        th.join();
+    }
+    a->flush_cache();
+    allocator_stats st = a->stats();
+    for (const worker& w : workers) {
+        ok = ok && w.ok;
+    }
+    if (!ok || st.live_blocks || st.used_bytes) {
+        std::cout << "Blocks were lost...\n";
+    } else {
+        std::cout << "Flush test passed.\n";
+    }
+
+    delete a;
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <stdlib.h> /* rand */
+#include <unistd.h> /* unlink */
+#include <chrono> /* steady_clock */
+
+#include "coins.h"
+
+#define MAX_AMOUNT 100000
+#define SLOW_QUERIES 200
+#define QUERIES 1000000
+/* Answers can be tens of thousands of coins long */
+#define CHANGE_QUERIES 10000
+#define LARGE_AMOUNT 50000000
+#define TABLE_PATH "/tmp/bench_coins.table"
+
+template<typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/* Solution::min_coins() per query against one table for all of them. */
+void compare(const char* name, const vector<int>& coins) {
+    vector<int> targets(QUERIES);
+    for(int& target : targets) {
+        target = std::rand() % MAX_AMOUNT;
+    }
+    bool same = true;
+    double slow = seconds([&] {
+        coin_change table(coins, MAX_AMOUNT);
+        for(int i = 0; i < SLOW_QUERIES; ++i) {
+            vector<int> solution = Solution::min_coins(coins, targets[i]);
+            long expected = solution.empty() && targets[i] > 0 ? -1 : solution.size();
+            same = same && table.count(targets[i]) == expected;
+        }
+    });
+    long total = 0, coins_out = 0;
+    coin_change* table = NULL;
+    double build = seconds([&] {
+        table = new coin_change(coins, MAX_AMOUNT);
+    });
+    double count = seconds([&] {
+        for(int target : targets) {
+            total += table->count(target);
+        }
+    });
+    vector<int> change;
+    double reconstruct = seconds([&] {
+        for(int i = 0; i < CHANGE_QUERIES; ++i) {
+            int target = targets[i];
+            change.clear();
+            table->change(target, change);
+            coins_out += change.size();
+        }
+    });
+    printf("%-14s %12.0f %9.4fs %10.1f %10.1f %5dB%s\n", name,
+           SLOW_QUERIES / slow, build, QUERIES / count / 1e6,
+           coins_out / reconstruct / 1e6,
+           table->cell_size(), same ? "" : "  (results differ!)");
+    delete table;
+    (void)total;
+}
+
+/* min_coins() against min_coins_blocked() for one large target. */
+void kernel(int target, int num_coins) {
+    vector<int> coins;
+    while((int)coins.size() < num_coins) {
+        int coin = 1 + std::rand() % 1000;
+        if(find(coins.begin(), coins.end(), coin) == coins.end()) {
+            coins.push_back(coin);
+        }
+    }
+    vector<int> original, blocked;
+    double slow = seconds([&] {
+        original = Solution::min_coins(coins, target);
+    });
+    double fast = seconds([&] {
+        blocked = Solution::min_coins_blocked(coins, target);
+    });
+    long sum = 0;
+    for(int coin : blocked) {
+        sum += coin;
+    }
+    double cells = (double)target*num_coins;
+    printf("%9d %6d %10.3fs %6.2f %10.3fs %6.2f %7.1fx%s\n", target, num_coins,
+           slow, cells / slow / 1e9, fast, cells / fast / 1e9, slow / fast,
+           original.size() == blocked.size() &&
+           (blocked.empty() || sum == target) ? "" : "  (results differ!)");
+}
+
+/* Building a large table against mapping a saved one, and growing it. */
+void large(const vector<int>& coins) {
+    coin_change built;
+    double build = seconds([&] {
+        coin_change table(coins, LARGE_AMOUNT);
+        table.save(TABLE_PATH);
+    });
+    coin_change loaded;
+    long sum = 0;
+    double load = seconds([&] {
+        loaded.load(TABLE_PATH);
+        for(int i = 0; i < QUERIES; ++i) {
+            sum += loaded.count(std::rand() % LARGE_AMOUNT);
+        }
+    });
+    double grow = seconds([&] {
+        for(long amount = 1; amount <= LARGE_AMOUNT; amount += LARGE_AMOUNT / 100) {
+            sum += built.count(amount);
+        }
+    });
+    printf("%d amounts, %dB cells: build and save %.3fs, load and query "
+           "%.3fs, grown by queries %.3fs\n", LARGE_AMOUNT, loaded.cell_size(),
+           build, load, grow);
+    unlink(TABLE_PATH);
+    (void)sum;
+}
+
+int main() {
+    vector<int> us = {1, 5, 10, 25, 50, 100};
+    vector<int> odd = {7, 11, 13, 17};
+    vector<int> ones = {1, 3};
+
+    printf("amounts up to %d                  count()   change()\n",
+           MAX_AMOUNT);
+    printf("coins          min_coins()/s     build        M/s   Mcoins/s  cell\n");
+    compare("US cents", us);
+    compare("7, 11, 13, 17", odd);
+    compare("1, 3", ones);
+
+    printf("\n");
+    large(us);
+
+    printf("\n   target  coins  min_coins() Gcells/s    blocked Gcells/s  speedup\n");
+    for(int target : {1000000, 10000000, 40000000}) {
+        for(int num_coins : {4, 16, 48}) {
+            kernel(target, num_coins);
+        }
+    }
+
+    return 0;
+}
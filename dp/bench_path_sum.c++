@@ -0,0 +1,183 @@
+#include <stdlib.h> /* rand */
+#include <chrono> /* steady_clock */
+
+#include "path_sum_batch.h"
+
+#define POOL_SIZE (1 << 20)
+#define BATCH_PATH "/tmp/bench_path_sum_batch"
+#define BATCH_ROWS 400
+#define BATCH_BYTES (64 << 20)
+
+template<typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/* Row i of a triangle is a slice of a pool of random numbers, so large
+ * triangles need neither the memory nor the time to generate them. */
+const int* pool_row(const vector<int>& pool, int i) {
+    return pool.data() + (uint64_t)i*7919 % (pool.size() - i);
+}
+
+/* Both solvers on the same triangle, with paths. */
+void compare(const vector<int>& pool, int rows) {
+    vector<vector<int>> triangle(rows);
+    for(int i = 0; i < rows; ++i) {
+        triangle[i].assign(pool_row(pool, i), pool_row(pool, i) + i + 1);
+    }
+
+    deque<int> path, rolling_path;
+    int answer = 0, rolling_answer = 0;
+    double original = seconds([&] {
+        answer = Solution::max_sum(triangle, path);
+    });
+    double rolling = seconds([&] {
+        rolling_path_sum solver(true);
+        solver.reserve(rows);
+        for(const vector<int>& row : triangle) {
+            solver.add_row(row);
+        }
+        rolling_answer = solver.max_sum();
+        solver.path(rolling_path);
+    });
+    printf("%6d %12.3fs %12.3fs %8.1fx%s\n", rows, original, rolling,
+           original / rolling,
+           answer == rolling_answer && path == rolling_path ?
+           "" : "  (results differ!)");
+}
+
+/* The rolling solver alone on rows streamed from the pool. */
+void stream(const vector<int>& pool, int rows) {
+    double cells = (double)rows*(rows + 1)/2;
+    int sums[2];
+    double secs[2];
+    for(int keep_path = 0; keep_path < 2; ++keep_path) {
+        secs[keep_path] = seconds([&] {
+            rolling_path_sum solver(keep_path);
+            solver.reserve(rows);
+            for(int i = 0; i < rows; ++i) {
+                solver.add_row(pool_row(pool, i));
+            }
+            sums[keep_path] = solver.max_sum();
+            deque<int> path;
+            solver.path(path);
+        });
+    }
+    printf("%6d %10.3fs %10.2f %10.3fs %10.2f %8.0f MB%s\n", rows, secs[0],
+           cells / secs[0] / 1e9, secs[1], cells / secs[1] / 1e9,
+           cells / 8 / 1e6, sums[0] == sums[1] ? "" : "  (results differ!)");
+}
+
+/* Test cases of BATCH_ROWS rows, as path_sum reads them. */
+bool write_batch(const vector<int>& pool, const char* path) {
+    FILE* f = fopen(path, "w");
+    if(f == NULL) {
+        return false;
+    }
+    long bytes_per_case = (long)BATCH_ROWS*(BATCH_ROWS + 1)/2*3;
+    int cases = BATCH_BYTES / bytes_per_case;
+    fprintf(f, "%d\n", cases);
+    for(int c = 0; c < cases; ++c) {
+        fprintf(f, "%d\n", BATCH_ROWS);
+        for(int i = 0; i < BATCH_ROWS; ++i) {
+            const int* row = pool_row(pool, c*BATCH_ROWS + i);
+            for(int j = 0; j <= i; ++j) {
+                fprintf(f, j < i ? "%d " : "%d\n", row[j]);
+            }
+        }
+    }
+    return fclose(f) == 0;
+}
+
+/* What path_sum used to do: cin >> for every number, then one printf per
+ * number of the triangle. */
+void classic(FILE* out) {
+    int test_cases;
+    cin >> test_cases;
+    for(int i = 0; i < test_cases; ++i) {
+        int rows;
+        cin >> rows;
+        vector<vector<int>> triangle(rows);
+        Solution::read_input(rows, triangle);
+        rolling_path_sum solver(true);
+        for(const vector<int>& row : triangle) {
+            solver.add_row(row);
+        }
+        deque<int> path;
+        fprintf(out, "%d\n", solver.max_sum());
+        solver.path(path);
+        for(int r = 0; r < rows; ++r) {
+            for(int j = 0; j <= r; ++j) {
+                if(j == path[r]) {
+                    fprintf(out, ANSI_COLOR_GREEN "%02d" ANSI_COLOR_RESET, triangle[r][j]);
+                } else {
+                    fprintf(out, "%02d", triangle[r][j]);
+                }
+                fprintf(out, " ");
+            }
+            fprintf(out, "\n");
+        }
+    }
+}
+
+/* End to end MB/s of reading, solving and printing a batch file. */
+void batch(const vector<int>& pool) {
+    if(!write_batch(pool, BATCH_PATH)) {
+        printf("cannot write %s\n", BATCH_PATH);
+        return;
+    }
+    FILE* out = fopen("/dev/null", "w");
+    input_file input;
+    double mb = 0;
+    double classic_secs = seconds([&] {
+        if(freopen(BATCH_PATH, "r", stdin) != NULL) {
+            classic(out);
+        }
+    });
+    printf("%-28s %8.1f MB/s\n", "cin and printf", input.open(BATCH_PATH) ?
+           (mb = input.size() / 1e6) / classic_secs : 0);
+    int threads = std::thread::hardware_concurrency();
+    for(int print_path = 1; print_path >= 0; --print_path) {
+        for(int n = 1; n <= threads; n = n < threads ? min(2*n, threads) : n + 1) {
+            bool ok = false;
+            double secs = seconds([&] {
+                input_file in;
+                path_sum_batch solver(n, print_path);
+                ok = in.open(BATCH_PATH) && solver.run(in.data(), in.size(), out);
+            });
+            char name[64];
+            snprintf(name, sizeof(name), "batch, %d thread%s%s", n, n > 1 ? "s" : "",
+                     print_path ? "" : ", no paths");
+            printf("%-28s %8.1f MB/s%s\n", name, mb / secs,
+                   ok ? "" : "  (failed!)");
+        }
+    }
+    fclose(out);
+    unlink(BATCH_PATH);
+}
+
+int main() {
+    vector<int> pool(POOL_SIZE);
+    for(int& num : pool) {
+        num = std::rand() % 100;
+    }
+
+    printf("  rows     max_sum()      rolling  speedup\n");
+    compare(pool, 2000);
+    compare(pool, 5000);
+    compare(pool, 10000);
+
+    printf("\n  rows   sum only  Gcells/s  with path  Gcells/s  path bits\n");
+    stream(pool, 10000);
+    stream(pool, 20000);
+    stream(pool, 50000);
+
+    printf("\n%d MB of %d-row test cases, %u hardware threads\n",
+           BATCH_BYTES >> 20, BATCH_ROWS, std::thread::hardware_concurrency());
+    batch(pool);
+
+    return 0;
+}
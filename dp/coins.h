@@ -0,0 +1,538 @@
+#ifndef _COINS_H_
+#define _COINS_H_
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <limits>
+#include <fcntl.h> /* open */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h> /* mmap, munmap */
+#include <sys/stat.h> /* fstat */
+#include <unistd.h> /* close */
+
+using namespace std;
+
+/* Bytes of table per block of min_coins_blocked(), sized to stay in L2 */
+#define COIN_BLOCK_BYTES (128 << 10)
+
+/*
+ * dst[i] = min(dst[i], src[i] + 1). The two ranges never overlap, so the
+ * iterations do not depend on each other. They go 16 bytes at a time: at
+ * -O2 GCC only vectorizes loops whose trip count is a multiple of the
+ * vector length, which the inner loop's is.
+ */
+template<typename Cell>
+inline void relax_cells(Cell* __restrict dst, const Cell* __restrict src, long n) {
+    const int lanes = 16 / sizeof(Cell);
+    long i = 0;
+    for(; i + lanes <= n; i += lanes) {
+        for(int j = 0; j < lanes; ++j) {
+            Cell c = src[i + j] + 1;
+            dst[i + j] = c < dst[i + j] ? c : dst[i + j];
+        }
+    }
+    for(; i < n; ++i) {
+        Cell c = src[i] + 1;
+        dst[i] = c < dst[i] ? c : dst[i];
+    }
+}
+
+/*
+ * Fewest coins for every amount up to 'target' into dp, with
+ * numeric_limits<Cell>::max() - 1 for amounts that cannot be made (so
+ * that adding one coin to it does not wrap around). 'coins' must be
+ * positive and sorted. Counts saturate: a cell ends up holding the
+ * smaller of the count and "unreachable", so counts that do not fit in a
+ * Cell look unreachable and all other cells are still exact.
+ *
+ * The table is filled coin by coin, dp[x] = min(dp[x], dp[x - c] + 1),
+ * rather than amount by amount over every coin, which has no branches.
+ * dp[x] reads dp[x - c], written earlier in the same pass, so the pass
+ * runs in chunks of c amounts: within a chunk nothing depends on anything
+ * else. The passes of all coins are done on one COIN_BLOCK_BYTES block
+ * at a time, instead of on the whole table, so that the table is read
+ * from memory once instead of once per coin.
+ */
+template<typename Cell>
+void coin_major_counts(const vector<int>& coins, long target, vector<Cell>& dp) {
+    const Cell unreachable = numeric_limits<Cell>::max() - 1;
+    const long block = COIN_BLOCK_BYTES / sizeof(Cell);
+    dp.assign(target + 1, unreachable);
+    dp[0] = 0;
+    Cell* cells = dp.data();
+    for(long lo = 1; lo <= target; lo += block) {
+        long hi = min(lo + block, target + 1);
+        for(int coin : coins) {
+            for(long start = max(lo, (long)coin); start < hi; start += coin) {
+                relax_cells(cells + start, cells + start - coin,
+                            min((long)coin, hi - start));
+            }
+        }
+    }
+}
+
+/*
+ * Coins that add up to 'amount' in a table from coin_major_counts(): the
+ * next coin is any c with dp[amount - c] one less than dp[amount], so no
+ * table of choices is needed. False if 'amount' cannot be made.
+ */
+template<typename Cell>
+bool change_from_counts(const vector<int>& coins, const vector<Cell>& dp,
+                        long amount, vector<int>& out) {
+    if(dp[amount] == numeric_limits<Cell>::max() - 1) {
+        return false;
+    }
+    while(amount > 0) {
+        int k = coins.size() - 1;
+        while(coins[k] > amount || dp[amount - coins[k]] + 1 != dp[amount]) {
+            --k;
+        }
+        out.push_back(coins[k]);
+        amount -= coins[k];
+    }
+    return true;
+}
+
+class Solution {
+
+public:
+    static void get_input(vector<int>& coins, int& target) {
+        printf("Enter coins available (-1 to stop): \n");
+        int input;
+        do {
+            printf(">> ");
+            cin >> input;
+            coins.push_back(input);
+        } while(input != -1);
+        coins.pop_back();
+
+        printf("Enter target: ");
+        cin >> target;
+        printf("\n");
+    }
+
+    static vector<int> min_coins(const vector<int>& coins, const int& target) {
+        vector<int> dp(target + 1, target);
+        vector<int> path_to_success(target + 1);
+
+        dp[0] = 0;
+        for(int x = 1; x <= target; ++x) {
+            int smallest = target;
+            int best_coin = -1;
+            for(int coin : coins) {
+                if(x >= coin) {
+                    if(dp[x - coin] + 1 < smallest) {
+                        smallest = dp[x - coin] + 1;
+                        best_coin = coin;
+                    }
+                }
+            }
+            dp[x] = smallest;
+            path_to_success[x] = best_coin;
+        }
+
+        vector<int> coins_needed;
+        int amount_left = target;
+        while (amount_left > 0) {
+            int next_coint = path_to_success[amount_left];
+            if(next_coint == -1){
+                /* If no solution, return emtpy vector. */
+                return vector<int>(0);
+            }
+            coins_needed.push_back(next_coint);
+            amount_left -= next_coint;
+        }
+
+        return coins_needed;
+    }
+
+    /*
+     * Same result as min_coins() (up to ties between solutions), from
+     * coin_major_counts() with 16-bit cells. Every amount on the way to
+     * the target needs fewer coins than the target itself, so if the
+     * target fits in 16 bits the whole answer is exact; only when it does
+     * not (or cannot be made at all) is it worked out again in 32 bits.
+     */
+    static vector<int> min_coins_blocked(const vector<int>& coins, long target) {
+        vector<int> sorted;
+        for(int coin : coins) {
+            if(coin > 0) {
+                sorted.push_back(coin);
+            }
+        }
+        sort(sorted.begin(), sorted.end());
+        sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+
+        vector<int> coins_needed;
+        if(sorted.empty() || target < 0) {
+            return coins_needed;
+        }
+        vector<uint16_t> dp;
+        coin_major_counts(sorted, target, dp);
+        /* No count is larger than target / smallest coin */
+        if(change_from_counts(sorted, dp, target, coins_needed) ||
+           target / sorted[0] < UINT16_MAX - 1) {
+            return coins_needed;
+        }
+        vector<uint16_t>().swap(dp);
+        vector<uint32_t> wide;
+        coin_major_counts(sorted, target, wide);
+        change_from_counts(sorted, wide, target, coins_needed);
+        return coins_needed;
+    }
+
+    static void validate_solution(const vector<int>& solution) {
+        if(solution.size() == 0) {
+            printf("No solution found.\n");
+        }
+        else {
+            printf("Minimum coins needed: %lu\n", solution.size());
+            printf("Specifically: ");
+            for(int coin : solution) {
+                printf("%d, ", coin);
+            }
+            printf("\n");
+        }
+    }
+
+};
+
+/* "COIN" in a little endian file */
+#define COIN_TABLE_MAGIC 0x4e494f43
+/* Counts never exceed the amount, so they always fit in 4-byte cells */
+#define COIN_MAX_AMOUNT ((long)UINT32_MAX - 1)
+
+/*
+ * Same problem as Solution::min_coins(), for many targets and one set of
+ * coins: the table for every amount up to max_amount() is built once,
+ * after which a count is one lookup and the coins themselves take one
+ * lookup each. A target past the end grows the table, at least doubling
+ * it, so only the new amounts are computed.
+ *
+ * Every amount has two cells: the fewest coins that add up to it and the
+ * index of the last coin used, with the largest value of the cell type
+ * meaning "no way to make it". Cells are 1, 2 or 4 bytes, the narrowest
+ * that holds every count so far and every coin index; the table is
+ * widened the first time a count does not fit.
+ *
+ * save() writes the table to a file that load() maps back into memory as
+ * it is, in native byte order, so a large table is ready without being
+ * read or recomputed. A loaded table is copied only if it has to grow.
+ */
+class coin_change {
+    struct file_header {
+        uint32_t magic;
+        uint32_t cell_bytes;
+        uint64_t coins;
+        uint64_t amounts; /* max_amount() + 1 */
+    };
+
+    vector<int> coin_values; /* sorted, without duplicates */
+    int cell_bytes;
+    long max_amount_;
+    /* Point into either 'owned' or 'mapping' */
+    const uint8_t* counts;
+    const uint8_t* choices;
+    vector<uint8_t> owned;
+    void* mapping;
+    size_t mapping_size;
+
+    /* Largest value of a cell, which stands for "unreachable". */
+    static uint64_t none(int bytes) {
+        return bytes == 4 ? UINT32_MAX : bytes == 2 ? UINT16_MAX : UINT8_MAX;
+    }
+
+    uint64_t none() const {
+        return none(cell_bytes);
+    }
+
+    uint64_t cell(const uint8_t* cells, long i) const {
+        switch(cell_bytes) {
+        case 1:
+            return cells[i];
+        case 2:
+            return ((const uint16_t*)cells)[i];
+        default:
+            return ((const uint32_t*)cells)[i];
+        }
+    }
+
+    /* Counts first, then choices; each rounded up to 8 bytes so that
+     * they stay aligned in a file too. */
+    static size_t cells_size(long amounts, int bytes) {
+        return (amounts*bytes + 7) & ~(size_t)7;
+    }
+
+    /*
+     * Fills amounts [from, to]. Stops early and returns the first amount
+     * whose count does not fit in a Cell; returns to + 1 when done.
+     */
+    template<typename Cell>
+    long fill(long from, long to) {
+        Cell* count = (Cell*)owned.data();
+        Cell* choice = (Cell*)(owned.data() + cells_size(max_amount_ + 1, sizeof(Cell)));
+        const uint64_t unreachable = numeric_limits<Cell>::max();
+        const int* coin = coin_values.data();
+        const int n = coin_values.size();
+        for(long x = from; x <= to; ++x) {
+            /* An unreachable x - coin gives unreachable + 1, which never
+             * wins; a real count of 'unreachable' does and then overflows */
+            uint64_t best = unreachable + 1;
+            Cell best_coin = unreachable;
+            for(int k = 0; k < n && coin[k] <= x; ++k) {
+                uint64_t c = (uint64_t)count[x - coin[k]] + 1;
+                if(c < best) {
+                    best = c;
+                    best_coin = k;
+                }
+            }
+            if(best == unreachable) {
+                return x;
+            }
+            count[x] = best_coin == unreachable ? unreachable : best;
+            choice[x] = best_coin;
+        }
+        return to + 1;
+    }
+
+    long fill(long from, long to) {
+        switch(cell_bytes) {
+        case 1:
+            return fill<uint8_t>(from, to);
+        case 2:
+            return fill<uint16_t>(from, to);
+        default:
+            return fill<uint32_t>(from, to);
+        }
+    }
+
+    static void store(uint8_t* cells, int bytes, long i, uint64_t value) {
+        switch(bytes) {
+        case 1:
+            cells[i] = value;
+            break;
+        case 2:
+            ((uint16_t*)cells)[i] = value;
+            break;
+        default:
+            ((uint32_t*)cells)[i] = value;
+        }
+    }
+
+    /*
+     * Moves the table into 'owned', with room for 'amounts' amounts of
+     * 'bytes' bytes each. The first 'known' amounts keep their cells, with
+     * "unreachable" translated to the new width.
+     */
+    void rebuild(long known, long amounts, int bytes) {
+        vector<uint8_t> table(2*cells_size(amounts, bytes));
+        uint8_t* new_counts = table.data();
+        uint8_t* new_choices = table.data() + cells_size(amounts, bytes);
+        const uint64_t old_none = none();
+        const uint64_t new_none = none(bytes);
+        if(bytes == cell_bytes) {
+            memcpy(new_counts, counts, known*bytes);
+            memcpy(new_choices, choices, known*bytes);
+        } else {
+            for(long i = 0; i < known; ++i) {
+                uint64_t c = cell(counts, i), k = cell(choices, i);
+                store(new_counts, bytes, i, c == old_none ? new_none : c);
+                store(new_choices, bytes, i, k == old_none ? new_none : k);
+            }
+        }
+        unmap();
+        owned.swap(table);
+        cell_bytes = bytes;
+        counts = new_counts;
+        choices = new_choices;
+    }
+
+    void unmap() {
+        if(mapping != NULL) {
+            munmap(mapping, mapping_size);
+            mapping = NULL;
+            mapping_size = 0;
+        }
+    }
+
+    /* Sorts the coins and drops duplicates and coins worth nothing. */
+    void set_coins(const vector<int>& coins) {
+        coin_values.clear();
+        for(int coin : coins) {
+            if(coin > 0) {
+                coin_values.push_back(coin);
+            }
+        }
+        sort(coin_values.begin(), coin_values.end());
+        coin_values.erase(unique(coin_values.begin(), coin_values.end()),
+                          coin_values.end());
+    }
+
+    /* Empty table: only amount 0, made with no coins. */
+    void reset() {
+        unmap();
+        max_amount_ = 0;
+        cell_bytes = 1;
+        /* Coin indices must stay below "unreachable" too */
+        while(coin_values.size() >= none()) {
+            cell_bytes *= 2;
+        }
+        owned.assign(2*cells_size(1, cell_bytes), 0);
+        counts = owned.data();
+        choices = owned.data() + cells_size(1, cell_bytes);
+        store(&owned[cells_size(1, cell_bytes)], cell_bytes, 0, none());
+    }
+
+public:
+    coin_change() : coin_values(), cell_bytes(1), max_amount_(0), counts(NULL),
+        choices(NULL), owned(), mapping(NULL), mapping_size(0) {
+        reset();
+    }
+
+    /* Table for 'coins' up to 'max_amount'. */
+    coin_change(const vector<int>& coins, long max_amount) : coin_values(),
+        cell_bytes(1), max_amount_(0), counts(NULL), choices(NULL), owned(),
+        mapping(NULL), mapping_size(0) {
+        set_coins(coins);
+        reset();
+        reserve(max_amount);
+    }
+
+    coin_change(const coin_change&) = delete;
+    coin_change& operator=(const coin_change&) = delete;
+
+    ~coin_change() {
+        unmap();
+    }
+
+    /* Makes sure every amount up to 'amount' is in the table. */
+    void reserve(long amount) {
+        amount = min(amount, COIN_MAX_AMOUNT);
+        if(amount <= max_amount_) {
+            return;
+        }
+        long from = max_amount_ + 1;
+        long to = min(max(amount, 2*max_amount_), COIN_MAX_AMOUNT);
+        rebuild(from, to + 1, cell_bytes);
+        max_amount_ = to;
+        while((from = fill(from, to)) <= to) {
+            rebuild(from, to + 1, 2*cell_bytes);
+        }
+    }
+
+    /* Fewest coins that add up to 'amount', or -1 if none do. */
+    long count(long amount) {
+        if(amount < 0 || amount > COIN_MAX_AMOUNT) {
+            return -1;
+        }
+        reserve(amount);
+        uint64_t c = cell(counts, amount);
+        return c == none() ? -1 : (long)c;
+    }
+
+    /* Appends those coins to 'out'; false if no coins add up to 'amount'. */
+    bool change(long amount, vector<int>& out) {
+        if(count(amount) < 0) {
+            return false;
+        }
+        while(amount > 0) {
+            /* A loaded table may point at a coin that does not fit */
+            uint64_t k = cell(choices, amount);
+            if(k >= coin_values.size() || coin_values[k] > amount) {
+                return false;
+            }
+            out.push_back(coin_values[k]);
+            amount -= coin_values[k];
+        }
+        return true;
+    }
+
+    long max_amount() const {
+        return max_amount_;
+    }
+
+    /* Bytes per cell: 1, 2 or 4. */
+    int cell_size() const {
+        return cell_bytes;
+    }
+
+    const vector<int>& coins() const {
+        return coin_values;
+    }
+
+    /* Writes the table to 'path'; false if it cannot be written. */
+    bool save(const char* path) const {
+        FILE* f = fopen(path, "wb");
+        if(f == NULL) {
+            return false;
+        }
+        file_header header = {COIN_TABLE_MAGIC, (uint32_t)cell_bytes,
+                              coin_values.size(), (uint64_t)max_amount_ + 1};
+        size_t size = cells_size(max_amount_ + 1, cell_bytes);
+        vector<int32_t> values(coin_values.begin(), coin_values.end());
+        values.resize((values.size() + 1) & ~(size_t)1, 0);
+        bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                  (values.empty() ||
+                   fwrite(values.data(), 4, values.size(), f) == values.size()) &&
+                  fwrite(counts, 1, size, f) == size &&
+                  fwrite(choices, 1, size, f) == size;
+        return fclose(f) == 0 && ok;
+    }
+
+    /*
+     * Maps a table written by save(). Returns false, leaving an empty
+     * table, if the file cannot be read or is not a valid table.
+     */
+    bool load(const char* path) {
+        coin_values.clear();
+        reset();
+        int fd = open(path, O_RDONLY);
+        if(fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(file_header)) {
+            close(fd);
+            return false;
+        }
+        void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(data == MAP_FAILED) {
+            return false;
+        }
+        file_header header;
+        memcpy(&header, data, sizeof(header));
+        int bytes = header.cell_bytes;
+        size_t values = (header.coins + 1) & ~(uint64_t)1;
+        bool ok = header.magic == COIN_TABLE_MAGIC &&
+                  (bytes == 1 || bytes == 2 || bytes == 4) &&
+                  header.amounts > 0 && header.amounts <= (uint64_t)st.st_size &&
+                  header.coins < (uint64_t)st.st_size &&
+                  header.coins < none(bytes) &&
+                  (uint64_t)st.st_size == sizeof(header) + 4*values +
+                                          2*cells_size(header.amounts, bytes);
+        const int32_t* coins = (const int32_t*)((const uint8_t*)data + sizeof(header));
+        for(size_t i = 0; ok && i < header.coins; ++i) {
+            ok = coins[i] > 0 && (i == 0 || coins[i] > coins[i - 1]);
+        }
+        if(!ok) {
+            munmap(data, st.st_size);
+            return false;
+        }
+        coin_values.assign(coins, coins + header.coins);
+        owned.clear();
+        mapping = data;
+        mapping_size = st.st_size;
+        cell_bytes = bytes;
+        max_amount_ = header.amounts - 1;
+        counts = (const uint8_t*)(coins + values);
+        choices = counts + cells_size(header.amounts, bytes);
+        return true;
+    }
+};
+
+#endif /* _COINS_H_ */
@@ -1,123 +1,59 @@
-#include <iostream>
-#include <utility>
-#include <vector>
-#include <deque>
-#include <climits>
-#include <stdio.h>
-
-/* set PRINT_PATH to 1 to print the path used to get the solution. */
-#define PRINT_PATH 1
-
-#define ANSI_COLOR_RED     "\x1b[31m"
-#define ANSI_COLOR_GREEN   "\x1b[32m"
-#define ANSI_COLOR_RESET   "\x1b[0m"
-
-using namespace std;
-
-class Solution {
-    static pair<int,int> max_adj(const int& i, const vector<int>& row) {
-        int max = INT_MIN;
-        int max_idx = -1;
-
-        if(i < row.size() && row[i] > max) {
-            max = row[i];
-            max_idx = i;
-        }
-        if(i >= 1 && row[i-1] > max) {
-            max = row[i-1];
-            max_idx = i-1;
+#include <chrono> /* steady_clock */
+
+#include "path_sum_batch.h"
+
+/*
+ * Usage: path_sum [-n] [-j threads] [-s] [file]
+ *   -n  only print the sums, not the triangles with their paths
+ *   -j  number of worker threads (all cores by default)
+ *   -s  report the throughput on stderr
+ * Reads standard input when no file is given.
+ */
+int main(int argc, char** argv) {
+    bool print_path = PRINT_PATH, stats = false;
+    int threads = std::thread::hardware_concurrency();
+    int opt;
+    while((opt = getopt(argc, argv, "nj:s")) != -1) {
+        switch(opt) {
+        case 'n':
+            print_path = false;
+            break;
+        case 'j':
+            threads = atoi(optarg);
+            break;
+        case 's':
+            stats = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n] [-j threads] [-s] [file]\n", argv[0]);
+            return 2;
         }
-        return make_pair(max, max_idx);
     }
-    static void build_path(int start, const vector<vector<int>>& history, deque<int>& path) {
-        int row = history.size() - 1;
-        while(row > 0) {
-            path.push_front(start);
-            start = history[row][start];
-            --row;
-        }
-        path.push_front(start);
-    }
-public:
-    static int max_sum(const vector<vector<int>>& triangle, deque<int>& path) {
-        /* Corner case: empty input */
-        if(triangle.size() < 1) { return -1; }
-
-        vector<vector<int>> history(triangle.size());
-        vector<vector<int>> dp(triangle.size());
-        /* dp[i][j] = max./best sum of all paths that end at dp[i][j]. */
-        /* Base case:  */
-        dp[0].push_back(triangle[0][0]);
-        /* Fill the dp matrix */
-        for(int i = 1; i < triangle.size(); ++i) {
-            for(int j = 0; j < triangle[i].size(); ++j) {
-                pair<int,int> p = max_adj(j, dp[i-1]);
-                history[i].push_back(p.second);
-                dp[i].push_back(p.first + triangle[i][j]);
-            }
-        }
-        /* Get the max. number of the bottom row of the dp matrix */
-        int _max = INT_MIN;
-        int _max_idx = -1;
-        const vector<int>& last_row = dp[dp.size()-1];
-        for(int i = 0; i < last_row.size(); ++i) {
-            int leaf = last_row[i];
-            if(leaf > _max) {
-                _max = leaf;
-                _max_idx = i;
-            }
-        }
-        if(PRINT_PATH) {
-            /* build the path followed to achieve the max. sum */
-            build_path(_max_idx, history, path);
-        }
 
-        return _max;
+    auto start = std::chrono::steady_clock::now();
+    input_file input;
+    bool ok = optind < argc ? input.open(argv[optind]) : input.open(STDIN_FILENO);
+    if(!ok) {
+        fprintf(stderr, "cannot read %s\n", optind < argc ? argv[optind] : "input");
+        return 1;
     }
 
-    static void read_input(const int& rows, vector<vector<int>>& triangle) {
-        int items = 1;
-        for(int i = 0; i < rows; ++i, ++items) {
-            for(int j = 0; j < items; ++j) {
-                int num;
-                cin >> num;
-                triangle[i].push_back(num);
-            }
-        }
+    static char out_buffer[1 << 20];
+    setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+    {
+        path_sum_batch batch(threads, print_path);
+        ok = batch.run(input.data(), input.size(), stdout);
     }
-
-    static void print_triangle(const vector<vector<int>>& triangle, const deque<int>& path) {
-        for(int i = 0; i < triangle.size(); ++i) {
-            for(int j = 0; j < triangle[i].size(); ++j) {
-                if(j == path[i]) { printf(ANSI_COLOR_GREEN "%02d" ANSI_COLOR_RESET, triangle[i][j]); }
-                else { printf("%02d", triangle[i][j]); }
-                printf(" ");
-            }
-            printf("\n");
-        }
+    fflush(stdout);
+    if(!ok) {
+        fprintf(stderr, "malformed input\n");
     }
-};
-
-int main() {
-
-    int test_cases;
-    cin >> test_cases;
-
-    for(int i = 0; i < test_cases; ++i) {
-        int rows;
-        cin >> rows;
-
-        vector<vector<int>> triangle(rows);
-        Solution::read_input(rows, triangle);
-
-        deque<int> path;
-        int answer = Solution::max_sum(triangle, path);
-
-        printf("%d\n", answer);
-        if(PRINT_PATH)
-            Solution::print_triangle(triangle, path);
+    if(stats) {
+        double secs = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        fprintf(stderr, "%.1f MB in %.3fs: %.1f MB/s\n", input.size() / 1e6,
+                secs, input.size() / 1e6 / secs);
     }
 
-
-    return 0;
+    return ok ? 0 : 1;
 }
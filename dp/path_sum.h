@@ -0,0 +1,218 @@
+#ifndef _PATH_SUM_H_
+#define _PATH_SUM_H_
+
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <deque>
+#include <climits>
+#include <stdint.h>
+#include <stdio.h>
+
+/* set PRINT_PATH to 1 to print the path used to get the solution. */
+#define PRINT_PATH 1
+
+#define ANSI_COLOR_RED     "\x1b[31m"
+#define ANSI_COLOR_GREEN   "\x1b[32m"
+#define ANSI_COLOR_RESET   "\x1b[0m"
+
+using namespace std;
+
+class Solution {
+    static pair<int,int> max_adj(const int& i, const vector<int>& row) {
+        int max = INT_MIN;
+        int max_idx = -1;
+
+        if(i < row.size() && row[i] > max) {
+            max = row[i];
+            max_idx = i;
+        }
+        if(i >= 1 && row[i-1] > max) {
+            max = row[i-1];
+            max_idx = i-1;
+        }
+        return make_pair(max, max_idx);
+    }
+    static void build_path(int start, const vector<vector<int>>& history, deque<int>& path) {
+        int row = history.size() - 1;
+        while(row > 0) {
+            path.push_front(start);
+            start = history[row][start];
+            --row;
+        }
+        path.push_front(start);
+    }
+public:
+    static int max_sum(const vector<vector<int>>& triangle, deque<int>& path) {
+        /* Corner case: empty input */
+        if(triangle.size() < 1) { return -1; }
+
+        vector<vector<int>> history(triangle.size());
+        vector<vector<int>> dp(triangle.size());
+        /* dp[i][j] = max./best sum of all paths that end at dp[i][j]. */
+        /* Base case:  */
+        dp[0].push_back(triangle[0][0]);
+        /* Fill the dp matrix */
+        for(int i = 1; i < triangle.size(); ++i) {
+            for(int j = 0; j < triangle[i].size(); ++j) {
+                pair<int,int> p = max_adj(j, dp[i-1]);
+                history[i].push_back(p.second);
+                dp[i].push_back(p.first + triangle[i][j]);
+            }
+        }
+        /* Get the max. number of the bottom row of the dp matrix */
+        int _max = INT_MIN;
+        int _max_idx = -1;
+        const vector<int>& last_row = dp[dp.size()-1];
+        for(int i = 0; i < last_row.size(); ++i) {
+            int leaf = last_row[i];
+            if(leaf > _max) {
+                _max = leaf;
+                _max_idx = i;
+            }
+        }
+        if(PRINT_PATH) {
+            /* build the path followed to achieve the max. sum */
+            build_path(_max_idx, history, path);
+        }
+
+        return _max;
+    }
+
+    static void read_input(const int& rows, vector<vector<int>>& triangle) {
+        int items = 1;
+        for(int i = 0; i < rows; ++i, ++items) {
+            for(int j = 0; j < items; ++j) {
+                int num;
+                cin >> num;
+                triangle[i].push_back(num);
+            }
+        }
+    }
+
+    static void print_triangle(const vector<vector<int>>& triangle, const deque<int>& path) {
+        for(int i = 0; i < triangle.size(); ++i) {
+            for(int j = 0; j < triangle[i].size(); ++j) {
+                if(j == path[i]) { printf(ANSI_COLOR_GREEN "%02d" ANSI_COLOR_RESET, triangle[i][j]); }
+                else { printf("%02d", triangle[i][j]); }
+                printf(" ");
+            }
+            printf("\n");
+        }
+    }
+};
+
+/*
+ * Same problem as Solution::max_sum(), solved one row at a time as the
+ * rows arrive, so the triangle never has to be in memory. 'dp' is the
+ * only row kept: row i is folded into it in place, right to left, since
+ * dp[j] needs the previous dp[j - 1] and dp[j]. That loop has no branches
+ * and vectorizes.
+ *
+ * The path is only kept on request, as one bit per cell saying whether
+ * the best path into it came from the upper left (1) or from straight
+ * above (0). Ties go straight up, as in Solution::max_sum(), so both
+ * find the same path.
+ */
+class rolling_path_sum {
+    vector<int> dp;
+    int rows;
+    bool keep_path;
+    vector<uint64_t> from_left;
+
+    /* Eight columns at a time: at -O2 GCC only vectorizes loops whose
+     * trip count is a multiple of the vector length. */
+    static void fold_row(int* __restrict sums, const int* __restrict row, int i) {
+        sums[i] = sums[i - 1] + row[i];
+        int j = i - 1;
+        for(; j >= 8; j -= 8) {
+            for(int k = 0; k < 8; ++k) {
+                int left = sums[j - k - 1], up = sums[j - k];
+                sums[j - k] = (left > up ? left : up) + row[j - k];
+            }
+        }
+        for(; j > 0; --j) {
+            sums[j] = (sums[j - 1] > sums[j] ? sums[j - 1] : sums[j]) + row[j];
+        }
+        sums[0] += row[0];
+    }
+
+    /* Index of the bit for column j of row i. */
+    static uint64_t cell(int i, int j) {
+        return (uint64_t)i*(i + 1)/2 + j;
+    }
+
+public:
+    explicit rolling_path_sum(bool _keep_path = false) :
+        dp(), rows(0), keep_path(_keep_path), from_left() {}
+
+    /* Room for 'n' rows without growing. */
+    void reserve(int n) {
+        dp.reserve(n);
+        if(keep_path) {
+            from_left.reserve(cell(n, 0)/64 + 1);
+        }
+    }
+
+    /* Adds the next row, which has one more number than the last one. */
+    void add_row(const int* row) {
+        int i = rows++;
+        dp.push_back(0);
+        if(i == 0) {
+            dp[0] = row[0];
+            if(keep_path) {
+                from_left.push_back(0);
+            }
+            return;
+        }
+        if(keep_path) {
+            from_left.resize(cell(i + 1, 0)/64 + 1, 0);
+            for(int j = 1; j < i; ++j) {
+                uint64_t bit = cell(i, j);
+                from_left[bit/64] |= (uint64_t)(dp[j - 1] > dp[j]) << bit%64;
+            }
+            uint64_t bit = cell(i, i);
+            from_left[bit/64] |= (uint64_t)1 << bit%64;
+        }
+        fold_row(dp.data(), row, i);
+    }
+
+    void add_row(const vector<int>& row) {
+        add_row(row.data());
+    }
+
+    /* Best sum so far, or -1 before any row was added. */
+    int max_sum() const {
+        if(rows == 0) {
+            return -1;
+        }
+        int _max = INT_MIN;
+        for(int sum : dp) {
+            _max = sum > _max ? sum : _max;
+        }
+        return _max;
+    }
+
+    /* Column of the best path in every row; needs keep_path. */
+    void path(deque<int>& out) const {
+        out.clear();
+        if(rows == 0 || !keep_path) {
+            return;
+        }
+        int j = 0;
+        for(int k = 1; k < rows; ++k) {
+            j = dp[k] > dp[j] ? k : j;
+        }
+        for(int i = rows - 1; i >= 0; --i) {
+            out.push_front(j);
+            uint64_t bit = cell(i, j);
+            j -= i > 0 && (from_left[bit/64] >> bit%64 & 1);
+        }
+    }
+
+    int size() const {
+        return rows;
+    }
+};
+
+#endif /* _PATH_SUM_H_ */
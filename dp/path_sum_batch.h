@@ -0,0 +1,311 @@
+#ifndef _PATH_SUM_BATCH_H_
+#define _PATH_SUM_BATCH_H_
+
+#include <fcntl.h> /* open */
+#include <sys/mman.h> /* mmap, munmap */
+#include <sys/stat.h> /* fstat */
+#include <unistd.h> /* read, close */
+#include <atomic>
+#include <deque>
+#include <string>
+#include <thread>
+
+#include "path_sum.h"
+#include "../queue/my_queue.h"
+
+/* Test cases in flight per worker */
+#define BATCH_JOBS_PER_WORKER 4
+
+/*
+ * Whole input in memory, without copying it when possible: regular files
+ * (a redirected standard input too) are mapped, and anything else, such
+ * as a pipe, is read into a buffer.
+ */
+class input_file {
+    const char* bytes;
+    size_t length;
+    void* mapping;
+    vector<char> buffer;
+
+    void close_input() {
+        if(mapping != NULL) {
+            munmap(mapping, length);
+            mapping = NULL;
+        }
+        buffer.clear();
+        bytes = NULL;
+        length = 0;
+    }
+
+public:
+    input_file() : bytes(NULL), length(0), mapping(NULL), buffer() {}
+
+    input_file(const input_file&) = delete;
+    input_file& operator=(const input_file&) = delete;
+
+    ~input_file() {
+        close_input();
+    }
+
+    /* Reads all of 'fd', which is left open. */
+    bool open(int fd) {
+        close_input();
+        struct stat st;
+        if(fstat(fd, &st) != 0) {
+            return false;
+        }
+        if(S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data != MAP_FAILED) {
+                madvise(data, st.st_size, MADV_SEQUENTIAL);
+                mapping = data;
+                bytes = (const char*)data;
+                length = st.st_size;
+                return true;
+            }
+        }
+        size_t used = 0;
+        buffer.resize(1 << 16);
+        ssize_t n;
+        while((n = ::read(fd, buffer.data() + used, buffer.size() - used)) > 0) {
+            used += n;
+            if(used == buffer.size()) {
+                buffer.resize(2*buffer.size());
+            }
+        }
+        buffer.resize(used);
+        bytes = buffer.data();
+        length = used;
+        return n == 0;
+    }
+
+    bool open(const char* path) {
+        int fd = ::open(path, O_RDONLY);
+        if(fd < 0) {
+            return false;
+        }
+        bool ok = open(fd);
+        close(fd);
+        return ok;
+    }
+
+    const char* data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+};
+
+/* Skips whitespace and parses an integer, which may be negative. Numbers
+ * beyond INT_MAX in magnitude are malformed input. */
+inline bool scan_int(const char*& p, const char* end, int& out) {
+    while(p < end && (unsigned char)*p <= ' ') {
+        ++p;
+    }
+    bool negative = p < end && *p == '-';
+    p += negative;
+    if(p == end || (unsigned)(*p - '0') > 9) {
+        return false;
+    }
+    int value = 0;
+    while(p < end && (unsigned)(*p - '0') <= 9) {
+        int digit = *p++ - '0';
+        if(value > (INT_MAX - digit) / 10) {
+            return false;
+        }
+        value = value*10 + digit;
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+/* Moves past 'n' whitespace separated tokens without converting them. */
+inline bool skip_tokens(const char*& p, const char* end, long n) {
+    for(long i = 0; i < n; ++i) {
+        while(p < end && (unsigned char)*p <= ' ') {
+            ++p;
+        }
+        if(p == end) {
+            return false;
+        }
+        while(p < end && (unsigned char)*p > ' ') {
+            ++p;
+        }
+    }
+    return true;
+}
+
+/* Appends 'value' as printf("%0<width>d") would, for width 1 or 2. */
+inline void append_int(string& out, int value, int width) {
+    char digits[12];
+    int n = 0;
+    unsigned magnitude = value < 0 ? 0u - value : value;
+    do {
+        digits[n++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while(magnitude > 0);
+    if(value < 0) {
+        digits[n++] = '-';
+    } else if(n < width) {
+        digits[n++] = '0';
+    }
+    while(n > 0) {
+        out.push_back(digits[--n]);
+    }
+}
+
+/*
+ * Runs the input of path_sum (the number of test cases, then for each one
+ * the number of rows and the rows) on a pool of threads, and writes the
+ * same output as path_sum always did, in input order.
+ *
+ * The calling thread only finds where each test case ends, by skipping
+ * over its numbers; the workers parse them, solve the case with
+ * rolling_path_sum and render its output into a string, which the calling
+ * thread then writes out in one go. A few cases per worker are in flight
+ * at once.
+ */
+class path_sum_batch {
+    struct case_job {
+        const char* begin;
+        const char* end;
+        int rows;
+        string output;
+        bool ok;
+        std::atomic<bool> done;
+    };
+
+    my_queue<case_job*> jobs;
+    /* Notified whenever a job is done; see block_compressor. */
+    my_signal finished;
+    std::vector<std::thread> workers;
+    bool print_path;
+
+    /* Without paths, each row is folded in as soon as it is parsed, so a
+     * case only needs room for one row; the triangle is kept only to
+     * print it. */
+    void solve(case_job* job) const {
+        int rows = job->rows;
+        vector<int> cells(print_path ? (long)rows*(rows + 1)/2 : rows);
+        const char* p = job->begin;
+        rolling_path_sum solver(print_path);
+        solver.reserve(rows);
+        job->ok = true;
+        for(int i = 0; job->ok && i < rows; ++i) {
+            int* row = cells.data() + (print_path ? (long)i*(i + 1)/2 : 0);
+            for(int j = 0; job->ok && j <= i; ++j) {
+                job->ok = scan_int(p, job->end, row[j]);
+            }
+            if(job->ok) {
+                solver.add_row(row);
+            }
+        }
+        if(!job->ok) {
+            return;
+        }
+        append_int(job->output, solver.max_sum(), 1);
+        job->output.push_back('\n');
+        if(!print_path) {
+            return;
+        }
+        /* Same as Solution::print_triangle() */
+        deque<int> path;
+        solver.path(path);
+        const int* cell = cells.data();
+        for(int i = 0; i < rows; ++i) {
+            for(int j = 0; j <= i; ++j, ++cell) {
+                if(j == path[i]) {
+                    job->output += ANSI_COLOR_GREEN;
+                    append_int(job->output, *cell, 2);
+                    job->output += ANSI_COLOR_RESET;
+                } else {
+                    append_int(job->output, *cell, 2);
+                }
+                job->output.push_back(' ');
+            }
+            job->output.push_back('\n');
+        }
+    }
+
+    void work() {
+        case_job* job;
+        while(jobs.wait_pop(job)) {
+            solve(job);
+            job->done = true;
+            finished.notify_all();
+        }
+    }
+
+public:
+    explicit path_sum_batch(int num_threads = std::thread::hardware_concurrency(),
+                            bool _print_path = PRINT_PATH) :
+        jobs(), finished(), workers(), print_path(_print_path)
+    {
+        num_threads = num_threads < 1 ? 1 : num_threads;
+        for(int i = 0; i < num_threads; ++i) {
+            workers.push_back(std::thread(&path_sum_batch::work, this));
+        }
+    }
+
+    path_sum_batch(const path_sum_batch&) = delete;
+    path_sum_batch& operator=(const path_sum_batch&) = delete;
+
+    ~path_sum_batch() {
+        jobs.close();
+        for(std::thread& t : workers) {
+            t.join();
+        }
+    }
+
+    /* Solves every test case in data[0, n) and writes the results to
+     * 'out'. Returns false if the input is malformed or truncated, after
+     * writing the results of the test cases before that point. */
+    bool run(const char* data, size_t n, FILE* out) {
+        const char* p = data;
+        const char* end = data + n;
+        int cases = 0;
+        /* A read error stops reading, but the cases before it are still
+         * written out */
+        bool read_ok = scan_int(p, end, cases), ok = true;
+        deque<case_job*> in_flight;
+        while(ok && ((read_ok && cases > 0) || !in_flight.empty())) {
+            while(read_ok && cases > 0 &&
+                  in_flight.size() < BATCH_JOBS_PER_WORKER*workers.size()) {
+                case_job* job = new case_job();
+                job->ok = false;
+                job->done = false;
+                read_ok = scan_int(p, end, job->rows) && job->rows >= 0;
+                job->begin = p;
+                read_ok = read_ok &&
+                          skip_tokens(p, end, (long)job->rows*(job->rows + 1)/2);
+                job->end = p;
+                if(read_ok) {
+                    in_flight.push_back(job);
+                    jobs.push(job);
+                    --cases;
+                } else {
+                    delete job;
+                }
+            }
+            if(in_flight.empty()) {
+                break;
+            }
+            case_job* job = in_flight.front();
+            in_flight.pop_front();
+            finished.wait([&] { return job->done.load(); });
+            ok = job->ok && fwrite(job->output.data(), 1, job->output.size(),
+                                   out) == job->output.size();
+            delete job;
+        }
+        /* On failure, let the remaining jobs finish before freeing them */
+        for(case_job* job : in_flight) {
+            finished.wait([&] { return job->done.load(); });
+            delete job;
+        }
+        return ok && read_ok;
+    }
+};
+
+#endif /* _PATH_SUM_BATCH_H_ */
@@ -0,0 +1,177 @@
+#include <stdlib.h> /* rand */
+#include <stdio.h> /* printf */
+#include <climits> /* INT_MIN */
+#include <chrono> /* steady_clock */
+#include <functional> /* greater */
+#include <queue> /* priority_queue */
+#include <string> /* string */
+#include <vector> /* vector */
+
+#include "my_heap.h"
+
+#define ELEMENTS 1000000
+#define STRING_ELEMENTS 200000
+
+/* Element that is expensive to copy but cheap to move. */
+struct keyed_string {
+    int key;
+    std::string payload;
+
+    keyed_string() : key(0), payload() {}
+    keyed_string(int _key) : key(_key), payload(64, 'x') {}
+    bool operator<(const keyed_string& rhs) const {
+        return key < rhs.key;
+    }
+    bool operator>(const keyed_string& rhs) const {
+        return key > rhs.key;
+    }
+};
+
+/* Element of exactly B bytes, ordered by its key. */
+template<int B>
+struct sized_key {
+    int key;
+    char payload[B - sizeof(int)];
+
+    sized_key() : key(0), payload() {}
+    sized_key(int _key) : key(_key), payload() {}
+    bool operator<(const sized_key& rhs) const {
+        return key < rhs.key;
+    }
+};
+
+inline int key_of(int value) {
+    return value;
+}
+
+template<typename T>
+int key_of(const T& value) {
+    return value.key;
+}
+
+/* Pops must come out in non-decreasing key order; 'disorder' counts those
+ * that do not. */
+struct pop_order {
+    int previous;
+    long long& disorder;
+
+    explicit pop_order(long long& _disorder) :
+        previous(INT_MIN), disorder(_disorder) {}
+    int operator()(int key) {
+        disorder += key < previous;
+        previous = key;
+        return key;
+    }
+};
+
+template<typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+template<typename T>
+void report(const char* name, const std::vector<T>& input) {
+    typedef std::priority_queue<T, std::vector<T>, std::greater<T> > std_heap;
+    /* Both heaps pop the same keys, in order, so the sums cancel out */
+    long long checksum = 0, disorder = 0;
+
+    double mine_push = seconds([&] {
+        my_heap<T> h;
+        pop_order order(disorder);
+        for(const T& value : input) {
+            h.push(value);
+        }
+        while(!h.empty()) {
+            checksum += order(key_of(h.pop()));
+        }
+    });
+    double std_push = seconds([&] {
+        std_heap h;
+        pop_order order(disorder);
+        for(const T& value : input) {
+            h.push(value);
+        }
+        while(!h.empty()) {
+            checksum -= order(key_of(h.top()));
+            h.pop();
+        }
+    });
+    double mine_build = seconds([&] {
+        my_heap<T> h(input.begin(), input.end());
+        pop_order order(disorder);
+        while(!h.empty()) {
+            checksum += order(key_of(h.pop()));
+        }
+    });
+    double std_build = seconds([&] {
+        std_heap h(input.begin(), input.end());
+        pop_order order(disorder);
+        while(!h.empty()) {
+            checksum -= order(key_of(h.top()));
+            h.pop();
+        }
+    });
+
+    printf("%-14s push+pop: %6.3fs vs %6.3fs  build+pop: %6.3fs vs %6.3fs%s\n",
+           name, mine_push, std_push, mine_build, std_build,
+           checksum || disorder ? "  (results differ!)" : "");
+}
+
+/* Time to push every element into a D-ary heap and pop them all back. */
+template<int D, typename T>
+double arity_seconds(const std::vector<T>& input, long long& checksum,
+                     long long& disorder) {
+    return seconds([&] {
+        my_heap<T, Compare<T>, D> h;
+        pop_order order(disorder);
+        for(const T& value : input) {
+            h.push(value);
+        }
+        while(!h.empty()) {
+            checksum += order(h.pop().key);
+        }
+    });
+}
+
+template<typename T>
+void sweep_arity(const char* name, int elements) {
+    std::vector<T> input;
+    for(int i = 0; i < elements; ++i) {
+        input.push_back(T(std::rand()));
+    }
+    /* Every arity pops the same keys, in order */
+    long long sums[4] = {0, 0, 0, 0}, disorder = 0;
+    printf("%-14s %8.3fs %8.3fs %8.3fs %8.3fs%s\n", name,
+           arity_seconds<2>(input, sums[0], disorder),
+           arity_seconds<4>(input, sums[1], disorder),
+           arity_seconds<8>(input, sums[2], disorder),
+           arity_seconds<16>(input, sums[3], disorder),
+           sums[0] == sums[1] && sums[0] == sums[2] && sums[0] == sums[3] &&
+           !disorder ? "" : "  (results differ!)");
+}
+
+int main() {
+    std::vector<int> ints;
+    std::vector<keyed_string> strings;
+    for(int i = 0; i < ELEMENTS; ++i) {
+        ints.push_back(std::rand());
+    }
+    for(int i = 0; i < STRING_ELEMENTS; ++i) {
+        strings.push_back(keyed_string(std::rand()));
+    }
+
+    printf("my_heap vs std::priority_queue\n");
+    report("int", ints);
+    report("keyed_string", strings);
+
+    printf("\n%-14s %9s %9s %9s %9s\n", "push+pop", "D=2", "D=4", "D=8",
+           "D=16");
+    sweep_arity<sized_key<4> >("4 bytes", ELEMENTS);
+    sweep_arity<sized_key<16> >("16 bytes", ELEMENTS);
+    sweep_arity<sized_key<64> >("64 bytes", ELEMENTS / 4);
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+#ifndef _INDEXED_HEAP_H_
+#define _INDEXED_HEAP_H_
+
+#include <stdexcept> /* invalid_argument */
+#include <utility> /* move */
+#include <vector> /* vector */
+
+#include "my_heap.h"
+
+/*
+ * D-ary min-heap of integer keys ordered by a priority (with respect to C).
+ * Every key is in the heap at most once, and 'pos' remembers where it is,
+ * so a key can be looked up in O(1) and have its priority lowered or be
+ * removed in O(log n). Keys are meant to be small and dense, like vertex
+ * numbers: 'pos' grows to the largest key pushed so far.
+ */
+template<typename T = int, typename C = Compare<T>, int D = 2>
+class indexed_heap {
+    static_assert(D >= 2, "A heap needs at least two children per node.");
+
+    struct entry {
+        T priority;
+        int key;
+    };
+
+    C cmp;
+    std::vector<entry> heap;
+    std::vector<int> pos;
+
+    const int parent(const int& idx) {
+        return (idx - 1)/D;
+    }
+    const int left(const int& idx) {
+        return D*idx + 1;
+    }
+    int best_child(int first) {
+        int best = first;
+        int last = first + D < (int)heap.size() ? first + D : heap.size();
+        for(int c = first + 1; c < last; ++c) {
+            best = cmp(heap[c].priority, heap[best].priority) ? c : best;
+        }
+        return best;
+    }
+    /* Writes 'e' at 'idx' and records its new position. */
+    void place(int idx, entry&& e) {
+        pos[e.key] = idx;
+        heap[idx] = std::move(e);
+    }
+    void sift_up(int idx) {
+        entry e = std::move(heap[idx]);
+        while(idx > 0 && cmp(e.priority, heap[parent(idx)].priority)) {
+            place(idx, std::move(heap[parent(idx)]));
+            idx = parent(idx);
+        }
+        place(idx, std::move(e));
+    }
+    void heapify(int root) {
+        entry e = std::move(heap[root]);
+        int child;
+        while((child = left(root)) < (int)heap.size()) {
+            child = best_child(child);
+            if(!cmp(heap[child].priority, e.priority)) {
+                break;
+            }
+            place(root, std::move(heap[child]));
+            root = child;
+        }
+        place(root, std::move(e));
+    }
+    /* Takes the entry at 'idx' out of the heap. */
+    void remove_at(int idx) {
+        pos[heap[idx].key] = -1;
+        entry last = std::move(heap.back());
+        heap.pop_back();
+        if(idx < (int)heap.size()) {
+            place(idx, std::move(last));
+            if(idx > 0 && cmp(heap[idx].priority, heap[parent(idx)].priority)) {
+                sift_up(idx);
+            } else {
+                heapify(idx);
+            }
+        }
+    }
+
+public:
+    indexed_heap() : heap(), pos() {}
+
+    /* Room for keys in [0, num_keys) without growing. */
+    explicit indexed_heap(int num_keys) : heap(), pos(num_keys, -1) {
+        heap.reserve(num_keys);
+    }
+
+    bool contains(int key) const {
+        return key >= 0 && key < (int)pos.size() && pos[key] >= 0;
+    }
+
+    /* Adds 'key' with the given priority; a key already in the heap just
+     * gets the new priority. Keys index 'pos', so they cannot be negative. */
+    void push(int key, const T& priority) {
+        if(key < 0) {
+            throw std::invalid_argument("Keys must not be negative.");
+        }
+        if(contains(key)) {
+            update(key, priority);
+            return;
+        }
+        if(key >= (int)pos.size()) {
+            pos.resize(key + 1, -1);
+        }
+        heap.push_back(entry{priority, key});
+        pos[key] = heap.size() - 1;
+        sift_up(heap.size() - 1);
+    }
+
+    /* Lowers the priority of 'key'. Returns false, and leaves the heap
+     * alone, if the key is missing or the priority is not smaller. */
+    bool decrease_key(int key, const T& priority) {
+        if(!contains(key) || !cmp(priority, heap[pos[key]].priority)) {
+            return false;
+        }
+        heap[pos[key]].priority = priority;
+        sift_up(pos[key]);
+        return true;
+    }
+
+    /* Sets the priority of 'key', moving it up or down as needed. */
+    void update(int key, const T& priority) {
+        if(!contains(key)) {
+            return;
+        }
+        int idx = pos[key];
+        bool up = cmp(priority, heap[idx].priority);
+        heap[idx].priority = priority;
+        if(up) {
+            sift_up(idx);
+        } else {
+            heapify(idx);
+        }
+    }
+
+    /* Removes 'key'; returns false if it was not in the heap. */
+    bool erase(int key) {
+        if(!contains(key)) {
+            return false;
+        }
+        remove_at(pos[key]);
+        return true;
+    }
+
+    /* Key with the smallest priority, or -1 if empty. */
+    int top() const {
+        return heap.empty() ? -1 : heap[0].key;
+    }
+
+    /* Smallest priority, or T() if empty. */
+    T top_priority() const {
+        T t = T();
+        if(!heap.empty())
+            t = heap[0].priority;
+        return t;
+    }
+
+    /* Priority of 'key', or T() if it is not in the heap. */
+    T priority(int key) const {
+        T t = T();
+        if(contains(key))
+            t = heap[pos[key]].priority;
+        return t;
+    }
+
+    /* Removes the key with the smallest priority and returns it, or -1 if
+     * empty. */
+    int pop() {
+        if(heap.empty()) {
+            return -1;
+        }
+        int key = heap[0].key;
+        remove_at(0);
+        return key;
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    int size() const {
+        return heap.size();
+    }
+};
+
+#endif /* _INDEXED_HEAP_H_ */
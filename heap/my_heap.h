@@ -1,86 +1,150 @@
-#include <algorithm> /* swap */
+#ifndef _MY_HEAP_H_
+#define _MY_HEAP_H_
+
+#include <utility> /* move, forward */
 #include <vector> /* vector */
 
-#define HEAP_MAX_SIZE 300
+#define HEAP_INITIAL_CAPACITY 300
 
 
 template<typename T>
-struct Compare { 
-    bool operator()(T lhs, T rhs) {
+struct Compare {
+    bool operator()(const T& lhs, const T& rhs) const {
         return lhs < rhs;
     }
 };
 
-template<typename T = int, typename C = Compare<T> >
+/*
+ * D-ary min-heap (with respect to C) that grows on demand; binary by
+ * default. The D children of a node are contiguous, so a wider heap is
+ * shallower and looks at each level's children within one or two cache
+ * lines. Sifting moves a "hole" along the path and writes the displaced
+ * element once at the end, instead of swapping at every level.
+ */
+template<typename T = int, typename C = Compare<T>, int D = 2>
 class my_heap {
+    static_assert(D >= 2, "A heap needs at least two children per node.");
     C cmp;
     long _size;
     std::vector<T> heap;
 
     const int parent(const int& idx) {
-        return (idx - 1)/2;
+        return (idx - 1)/D;
     }
     const int left(const int& idx) {
-        return 2*idx + 1;
-    }
-    const int right(const int& idx) {
-        return 2*idx + 2;
+        return D*idx + 1;
     }
-    void heapify(const int& root) {
-        int l = left(root);
-        int r = right(root);
-        int smallest = root;
-        if(l < _size && cmp(heap[l], heap[smallest])) {
-            smallest = l;
+    /* Smallest of the children that start at 'first'. The selection is
+     * written as a conditional move, so arithmetic keys compile to
+     * branch-free code, and the loop over a full set of D children is
+     * unrolled. */
+    int best_child(int first) {
+        int best = first;
+        if(first + D <= _size) {
+            for(int k = 1; k < D; ++k) {
+                best = cmp(heap[first + k], heap[best]) ? first + k : best;
+            }
+        } else {
+            for(int c = first + 1; c < _size; ++c) {
+                best = cmp(heap[c], heap[best]) ? c : best;
+            }
         }
-        if(r < _size && cmp(heap[r], heap[smallest])) {
-            smallest = r;
+        return best;
+    }
+    /* Moves 'heap[idx]' up until its parent is not greater than it. */
+    void sift_up(int idx) {
+        T value = std::move(heap[idx]);
+        while(idx > 0 && cmp(value, heap[parent(idx)])) {
+            heap[idx] = std::move(heap[parent(idx)]);
+            idx = parent(idx);
         }
-        if(smallest != root) {
-            std::swap(heap[smallest], heap[root]);
-            heapify(smallest);
+        heap[idx] = std::move(value);
+    }
+    /* Moves 'heap[root]' down until none of its children is smaller. */
+    void heapify(int root) {
+        T value = std::move(heap[root]);
+        int child;
+        while((child = left(root)) < _size) {
+            child = best_child(child);
+            if(!cmp(heap[child], value)) {
+                break;
+            }
+            heap[root] = std::move(heap[child]);
+            root = child;
         }
+        heap[root] = std::move(value);
     }
 
 public:
-    my_heap() : _size(0), heap(std::vector<T>(HEAP_MAX_SIZE)) {}
+    my_heap() : _size(0), heap() {
+        heap.reserve(HEAP_INITIAL_CAPACITY);
+    }
 
-    void push(const T& data) {
-        if(_size < heap.size() - 1) {
-            heap[_size] = data;
-            int i = _size;
-            int parent_idx = parent(i);
-            while(parent_idx >= 0 && cmp(heap[i], heap[parent_idx])) {
-                std::swap(heap[i], heap[parent_idx]);
-                i = parent_idx;
-                parent_idx = parent(i);
-            }
-            ++_size;
+    /* Builds a heap out of [first, last) in O(n) (Floyd's method). */
+    template<typename InputIt>
+    my_heap(InputIt first, InputIt last) : _size(0), heap(first, last) {
+        _size = heap.size();
+        for(int i = _size/2 - 1; i >= 0; --i) {
+            heapify(i);
         }
     }
 
+    void push(const T& data) {
+        heap.push_back(data);
+        sift_up(_size++);
+    }
+
+    void push(T&& data) {
+        heap.push_back(std::move(data));
+        sift_up(_size++);
+    }
+
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        heap.emplace_back(std::forward<Args>(args)...);
+        sift_up(_size++);
+    }
+
     T top() const{
-        T t;
+        T t = T();
         if(_size > 0)
             t = heap[0];
         return t;
     }
 
-    void pop() {
+    /* Removes the smallest element and returns it, or T() if empty. */
+    T pop() {
+        T t = T();
         if(_size > 0) {
-            heap[0] = heap[_size - 1];
-            --_size;
-            heapify(0);
+            t = std::move(heap[0]);
+            if(--_size > 0) {
+                heap[0] = std::move(heap[_size]);
+            }
+            heap.pop_back();
+            if(_size > 0) {
+                heapify(0);
+            }
         }
+        return t;
     }
 
+    /* Removes the element at position 'idx' of the underlying array. The
+     * last element takes its place and moves up or down from there. */
     void delete_at(int idx) {
-        heap[idx] = heap[0];
-        while(idx > 0 && cmp(heap[idx], heap[parent(idx)])) {
-            std::swap(heap[idx], heap[parent(idx)]);
-            --idx;
+        if(idx < 0 || idx >= _size) {
+            return;
+        }
+        if(--_size > idx) {
+            heap[idx] = std::move(heap[_size]);
+            heap.pop_back();
+            if(idx > 0 && cmp(heap[idx], heap[parent(idx)])) {
+                sift_up(idx);
+            } else {
+                heapify(idx);
+            }
+        } else {
+            heap.pop_back();
         }
-        pop();
     }
 
     bool empty() const {
@@ -90,4 +154,10 @@ public:
     int size() const {
         return _size;
     }
-};
\ No newline at end of file
+
+    void reserve(int capacity) {
+        heap.reserve(capacity);
+    }
+};
+
+#endif /* _MY_HEAP_H_ */
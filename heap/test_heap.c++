@@ -1,7 +1,10 @@
 #include <stdlib.h> /* rand */
 #include <iostream> /* cout, endl */
+#include <stdexcept> /* invalid_argument */
+#include <vector> /* vector */
 
 #include "my_heap.h"
+#include "indexed_heap.h"
 
 int main() {
     my_heap<int> h;
@@ -17,5 +20,94 @@ int main() {
     }
     std::cout << std::endl;
 
+    /* Well past the initial capacity, pushed one by one and built at once */
+    std::vector<int> nums;
+    for(int i = 0; i < 10000; ++i) {
+        nums.push_back(std::rand());
+        h.push(nums.back());
+    }
+    my_heap<int> built(nums.begin(), nums.end());
+    my_heap<int, Compare<int>, 4> quaternary(nums.begin(), nums.end());
+    my_heap<int, Compare<int>, 8> octonary;
+    for(int num : nums) {
+        octonary.push(num);
+    }
+    bool sorted = h.size() == 10000 && built.size() == 10000;
+    int previous = -1;
+    while(sorted && !h.empty()) {
+        int value = h.pop();
+        sorted = value >= previous && value == built.pop() &&
+                 value == quaternary.pop() && value == octonary.pop();
+        previous = value;
+    }
+    sorted = sorted && quaternary.empty() && octonary.empty();
+    std::cout << (sorted ? "Test passed." : "Something went wrong...")
+              << std::endl;
+
+    /* delete_at() in the middle, then everything else comes out in order */
+    for(int num : nums) {
+        h.push(num);
+    }
+    for(int i = 0; i < 1000; ++i) {
+        h.delete_at(std::rand() % h.size());
+    }
+    bool ordered = h.size() == 9000;
+    previous = -1;
+    while(ordered && !h.empty()) {
+        int value = h.pop();
+        ordered = value >= previous;
+        previous = value;
+    }
+
+    /* Indexed heap: random pushes, decrease_key() and erase() against a
+     * plain array of priorities (-1 for keys that are not in the heap) */
+    indexed_heap<int, Compare<int>, 4> ih;
+    std::vector<int> priority(1000, -1);
+    for(int i = 0; i < 20000; ++i) {
+        int key = std::rand() % priority.size();
+        int p = std::rand() % 100000;
+        switch(std::rand() % 3) {
+        case 0:
+            ih.push(key, p);
+            priority[key] = p;
+            break;
+        case 1:
+            if(ih.decrease_key(key, p) != (priority[key] > p)) {
+                ordered = false;
+            }
+            priority[key] = priority[key] > p ? p : priority[key];
+            break;
+        case 2:
+            if(ih.erase(key) != (priority[key] >= 0)) {
+                ordered = false;
+            }
+            priority[key] = -1;
+            break;
+        }
+        if(ih.contains(key) != (priority[key] >= 0) ||
+           ih.priority(key) != (priority[key] >= 0 ? priority[key] : 0)) {
+            ordered = false;
+        }
+    }
+    previous = -1;
+    while(ordered && !ih.empty()) {
+        int p = ih.top_priority();
+        int key = ih.pop();
+        ordered = p >= previous && priority[key] == p;
+        priority[key] = -1;
+        previous = p;
+    }
+    for(int p : priority) {
+        ordered = ordered && p == -1;
+    }
+    try {
+        ih.push(-1, 0);
+        ordered = false;
+    } catch(const std::invalid_argument&) {
+        ordered = ordered && ih.empty();
+    }
+    std::cout << (ordered ? "Test passed." : "Something went wrong...")
+              << std::endl;
+
     return 0;
 }
@@ -0,0 +1,122 @@
+#include <stdio.h> /* printf, fopen */
+#include <stdlib.h> /* rand */
+#include <unistd.h> /* unlink */
+#include <chrono> /* steady_clock */
+#include <thread> /* hardware_concurrency */
+#include <vector> /* vector */
+
+#include "block_compressor.h"
+
+#define INPUT_BYTES (64 << 20)
+#define MAX_THREADS 16
+#define INPUT_PATH "/tmp/bench_block_input"
+#define COMPRESSED_PATH "/tmp/bench_block_input.huf"
+#define OUTPUT_PATH "/tmp/bench_block_output"
+
+/* Log-like input: lines of skewed letters, digits and spaces. */
+bool write_input(const char* path, size_t n) {
+    FILE* f = fopen(path, "wb");
+    if(f == NULL) {
+        return false;
+    }
+    std::vector<char> line;
+    for(size_t written = 0; written < n; written += line.size()) {
+        line.clear();
+        int length = 40 + std::rand() % 80;
+        for(int i = 0; i < length; ++i) {
+            int r = std::rand();
+            int b = 0;
+            while(r & 1 && b < 30) {
+                r >>= 1;
+                ++b;
+            }
+            line.push_back(r % 7 == 0 ? ' ' : r % 11 == 0 ? '0' + b % 10 : 'a' + b);
+        }
+        line.push_back('\n');
+        fwrite(line.data(), 1, line.size(), f);
+    }
+    return fclose(f) == 0;
+}
+
+template<typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+bool same_files(const char* a, const char* b) {
+    FILE* fa = fopen(a, "rb");
+    FILE* fb = fopen(b, "rb");
+    bool same = fa && fb;
+    std::vector<char> ba(1 << 16), bb(1 << 16);
+    while(same) {
+        size_t na = fread(ba.data(), 1, ba.size(), fa);
+        size_t nb = fread(bb.data(), 1, bb.size(), fb);
+        same = na == nb && std::equal(ba.begin(), ba.begin() + na, bb.begin());
+        if(na == 0) {
+            break;
+        }
+    }
+    if(fa) {
+        fclose(fa);
+    }
+    if(fb) {
+        fclose(fb);
+    }
+    return same;
+}
+
+int main() {
+    if(!write_input(INPUT_PATH, INPUT_BYTES)) {
+        printf("cannot write %s\n", INPUT_PATH);
+        return 1;
+    }
+    double mb = INPUT_BYTES / 1e6;
+    double single_compress = 0, single_decompress = 0;
+    bool ok = true;
+
+    printf("%u hardware threads, %d MB input\n",
+           std::thread::hardware_concurrency(), INPUT_BYTES >> 20);
+    printf("threads  compress MB/s  speedup  decompress MB/s  speedup\n");
+    for(int n = 1; n <= MAX_THREADS; n <<= 1) {
+        block_compressor blocks(n);
+        double compress = seconds([&] {
+            ok = blocks.compress_file(INPUT_PATH, COMPRESSED_PATH) && ok;
+        });
+        double decompress = seconds([&] {
+            ok = blocks.decompress_file(COMPRESSED_PATH, OUTPUT_PATH) && ok;
+        });
+        ok = ok && same_files(INPUT_PATH, OUTPUT_PATH);
+        single_compress = n == 1 ? compress : single_compress;
+        single_decompress = n == 1 ? decompress : single_decompress;
+        printf("%7d %14.1f %7.2fx %16.1f %7.2fx\n", n, mb / compress,
+               single_compress / compress, mb / decompress,
+               single_decompress / decompress);
+    }
+
+    /* A single block: the one with the last byte, and none past it */
+    FILE* f = fopen(INPUT_PATH, "rb");
+    off_t input_bytes = f && fseeko(f, 0, SEEK_END) == 0 ? ftello(f) : 0;
+    if(f) {
+        fclose(f);
+    }
+    std::vector<uint8_t> block;
+    uint64_t first;
+    ok = ok && block_compressor::read_block(COMPRESSED_PATH, input_bytes - 1,
+                                            block, first) &&
+         first + block.size() == (uint64_t)input_bytes &&
+         !block_compressor::read_block(COMPRESSED_PATH, input_bytes, block,
+                                       first);
+    /* Without the magic in front, the file is not taken for a stream */
+    f = fopen(COMPRESSED_PATH, "r+b");
+    ok = ok && f && fputc('X', f) != EOF && fclose(f) == 0 &&
+         !block_compressor(1).decompress_file(COMPRESSED_PATH, OUTPUT_PATH);
+    unlink(INPUT_PATH);
+    unlink(COMPRESSED_PATH);
+    unlink(OUTPUT_PATH);
+    printf("%s\n", ok ? "Round trips OK." : "Something went wrong...");
+
+    return ok ? 0 : 1;
+}
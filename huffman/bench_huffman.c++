@@ -0,0 +1,153 @@
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <chrono> /* steady_clock */
+#include <string> /* string */
+#include <unordered_map> /* unordered_map */
+#include <vector> /* vector */
+
+#include "huffman.h"
+#include "canonical_huffman.h"
+#include "histogram.h"
+
+#define PACKED_BYTES (32 << 20)
+#define STRING_BYTES (2 << 20)
+
+/* Bytes with a skewed distribution, roughly like text: byte b is about
+ * twice as likely as byte b + 1 within the first few dozen values. */
+std::string skewed_data(size_t n) {
+    std::string data(n, 0);
+    for(size_t i = 0; i < n; ++i) {
+        int r = std::rand();
+        int b = 0;
+        while(r & 1 && b < 40) {
+            r >>= 1;
+            ++b;
+        }
+        data[i] = 'a' + b;
+    }
+    return data;
+}
+
+std::string random_data(size_t n) {
+    std::string data(n, 0);
+    for(size_t i = 0; i < n; ++i) {
+        data[i] = std::rand();
+    }
+    return data;
+}
+
+template<typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+Huffman* make_huffman(const std::string& data) {
+    uint64_t counts[256];
+    byte_histogram((const uint8_t*)data.data(), data.size(), counts);
+    std::vector<char> chars;
+    std::vector<int> freq;
+    for(int b = 0; b < 256; ++b) {
+        if(counts[b]) {
+            chars.push_back(b);
+            freq.push_back(counts[b]);
+        }
+    }
+    return new Huffman(chars, freq);
+}
+
+void report(const char* name, const std::string& data) {
+    Huffman* huff = make_huffman(data);
+    std::string sample = data.substr(0, STRING_BYTES);
+    double mb = data.size() / 1e6, sample_mb = sample.size() / 1e6;
+
+    std::string bit_string, string_decoded;
+    double string_encode = seconds([&] { bit_string = huff->encode(sample); });
+    double string_decode = seconds([&] {
+        string_decoded = huff->decode(bit_string);
+    });
+
+    std::vector<uint8_t> packed, decoded;
+    bool ok = true;
+    double packed_encode = seconds([&] {
+        huff->encode((const uint8_t*)data.data(), data.size(), packed);
+    });
+    double packed_decode = seconds([&] {
+        ok = huff->decode(packed.data(), packed.size(), data.size(), decoded);
+    });
+    ok = ok && string_decoded == sample &&
+         std::string(decoded.begin(), decoded.end()) == data;
+
+    std::vector<uint8_t> blob, restored;
+    double canonical_encode = seconds([&] {
+        canonical_huffman::compress((const uint8_t*)data.data(), data.size(),
+                                    blob);
+    });
+    double canonical_decode = seconds([&] {
+        ok = canonical_huffman::decompress(blob.data(), blob.size(),
+                                           restored) && ok;
+    });
+    ok = ok && std::string(restored.begin(), restored.end()) == data;
+
+    printf("%-7s %6.1f%% %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f%s\n", name,
+           100.0 * blob.size() / data.size(),
+           sample_mb / string_encode, sample_mb / string_decode,
+           mb / packed_encode, mb / packed_decode,
+           mb / canonical_encode, mb / canonical_decode,
+           ok ? "" : "  (round trip failed!)");
+    delete huff;
+}
+
+/* Byte counting the way get_chars_and_freq() used to, with one plain
+ * table, and with byte_histogram(). */
+void report_histogram(const char* name, const std::string& data) {
+    const uint8_t* bytes = (const uint8_t*)data.data();
+    double mb = data.size() / 1e6;
+    uint64_t single[256] = {0}, interleaved[256];
+    std::unordered_map<char, int> m;
+
+    double map_secs = seconds([&] {
+        for(char c : data) {
+            ++m[c];
+        }
+    });
+    double single_secs = seconds([&] {
+        for(size_t i = 0; i < data.size(); ++i) {
+            ++single[bytes[i]];
+        }
+    });
+    double interleaved_secs = seconds([&] {
+        byte_histogram(bytes, data.size(), interleaved);
+    });
+    bool same = true;
+    for(int b = 0; b < 256; ++b) {
+        auto it = m.find((char)b);
+        same = same && single[b] == interleaved[b] &&
+               (uint64_t)(it == m.end() ? 0 : it->second) == single[b];
+    }
+    printf("%-7s %14.1f %14.1f %14.1f%s\n", name, mb / map_secs,
+           mb / single_secs, mb / interleaved_secs,
+           same ? "" : "  (counts differ!)");
+}
+
+int main() {
+    printf("                    string MB/s       packed MB/s"
+           "    canonical MB/s\n");
+    printf("data      ratio   encode   decode   encode   decode"
+           "   encode   decode\n");
+    std::string skewed = skewed_data(PACKED_BYTES);
+    std::string random = random_data(PACKED_BYTES);
+    std::string runs(PACKED_BYTES, 'x');
+    report("skewed", skewed);
+    report("random", random);
+
+    printf("\n%-7s %14s %14s %14s\n", "count", "unordered_map", "single table",
+           "interleaved");
+    report_histogram("skewed", skewed);
+    report_histogram("random", random);
+    report_histogram("runs", runs);
+
+    return 0;
+}
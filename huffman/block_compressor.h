@@ -0,0 +1,336 @@
+#ifndef _BLOCK_COMPRESSOR_H_
+#define _BLOCK_COMPRESSOR_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "canonical_huffman.h"
+#include "../queue/my_queue.h"
+
+#define HUFFMAN_BLOCK_SIZE (1 << 20)
+#define HUFFMAN_STREAM_MAGIC "HUFS"
+/* Magic (4 bytes), block size (4 bytes) */
+#define HUFFMAN_STREAM_HEADER_BYTES 8
+/* Index offset (8 bytes), number of blocks (8 bytes), magic (4 bytes) */
+#define HUFFMAN_TRAILER_BYTES 20
+/* Compressed and original offset of a block, 8 bytes each */
+#define HUFFMAN_INDEX_ENTRY_BYTES 16
+
+/*
+ * Compresses files of any size as a sequence of independent blocks, each
+ * a canonical_huffman blob with its own code, on a pool of threads. Only
+ * a few blocks per thread are in memory at once, and they are written in
+ * input order as soon as they are ready.
+ *
+ * File layout: the 4-byte magic and the block size, the blocks, then an
+ * index with the compressed and original offset of every block, and a
+ * trailer pointing at the index. The index lets decompression run on all
+ * threads as well, or read a single block without the rest.
+ */
+class block_compressor {
+    struct block_job {
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+        bool compress;
+        bool ok;
+        std::atomic<bool> done;
+    };
+
+    my_queue<block_job*> jobs;
+    /* Notified whenever a job is done. It belongs to the compressor
+     * rather than the job, since the job may be freed as soon as 'done'
+     * is set. */
+    my_signal finished;
+    std::vector<std::thread> workers;
+    size_t block_size;
+
+    static void put_u64(std::vector<uint8_t>& out, uint64_t value) {
+        for(int i = 0; i < 8; ++i) {
+            out.push_back(value >> 8*i);
+        }
+    }
+    static uint64_t get_u64(const uint8_t* p) {
+        uint64_t value = 0;
+        for(int i = 0; i < 8; ++i) {
+            value |= (uint64_t)p[i] << 8*i;
+        }
+        return value;
+    }
+
+    void work() {
+        block_job* job;
+        while(jobs.wait_pop(job)) {
+            if(job->compress) {
+                canonical_huffman::compress(job->input.data(),
+                                            job->input.size(), job->output);
+                job->ok = true;
+            } else {
+                job->ok = canonical_huffman::decompress(job->input.data(),
+                                                        job->input.size(),
+                                                        job->output);
+            }
+            job->done = true;
+            finished.notify_all();
+        }
+    }
+
+    /*
+     * Hands the blocks that read() produces to the workers, and passes the
+     * results to write() in the same order. read() clears 'more' after the
+     * last block, and may leave that one empty. At most two blocks per
+     * worker are in flight. Returns false once a block fails or read() or
+     * write() does.
+     */
+    bool run(bool compress,
+             std::function<bool(std::vector<uint8_t>&, bool&)> read,
+             std::function<bool(const std::vector<uint8_t>&)> write) {
+        std::deque<block_job*> in_flight;
+        bool ok = true, more = true;
+        while(ok && (more || !in_flight.empty())) {
+            while(ok && more && in_flight.size() < 2*workers.size()) {
+                block_job* job = new block_job();
+                job->compress = compress;
+                job->ok = false;
+                job->done = false;
+                ok = read(job->input, more);
+                if(ok && !job->input.empty()) {
+                    in_flight.push_back(job);
+                    jobs.push(job);
+                } else {
+                    delete job;
+                }
+            }
+            if(in_flight.empty()) {
+                break;
+            }
+            block_job* job = in_flight.front();
+            in_flight.pop_front();
+            finished.wait([&] { return job->done.load(); });
+            ok = ok && job->ok && write(job->output);
+            delete job;
+        }
+        /* On failure, let the remaining jobs finish before freeing them */
+        for(block_job* job : in_flight) {
+            finished.wait([&] { return job->done.load(); });
+            delete job;
+        }
+        return ok;
+    }
+
+    /* Checks the header at the start of 'in' and reads the index at its
+     * end: the compressed offset of every block, followed by that of the
+     * index itself so that each block ends where the next entry starts,
+     * and the original offset of every block. 'block_bytes' is set to the
+     * block size from the header. */
+    static bool read_index(FILE* in, std::vector<uint64_t>& offsets,
+                           std::vector<uint64_t>& positions,
+                           uint64_t& block_bytes) {
+        uint8_t header[HUFFMAN_STREAM_HEADER_BYTES];
+        if(fseeko(in, 0, SEEK_SET) != 0 ||
+           fread(header, 1, sizeof(header), in) != sizeof(header) ||
+           memcmp(header, HUFFMAN_STREAM_MAGIC, 4) != 0) {
+            return false;
+        }
+        block_bytes = get_u64(header) >> 32;
+        uint8_t trailer[HUFFMAN_TRAILER_BYTES];
+        if(fseeko(in, -HUFFMAN_TRAILER_BYTES, SEEK_END) != 0 ||
+           fread(trailer, 1, sizeof(trailer), in) != sizeof(trailer) ||
+           memcmp(trailer + 16, HUFFMAN_STREAM_MAGIC, 4) != 0) {
+            return false;
+        }
+        uint64_t index = get_u64(trailer);
+        uint64_t blocks = get_u64(trailer + 8);
+        off_t end = ftello(in) - HUFFMAN_TRAILER_BYTES;
+        if(index > (uint64_t)end ||
+           blocks != (end - index) / HUFFMAN_INDEX_ENTRY_BYTES ||
+           fseeko(in, index, SEEK_SET) != 0) {
+            return false;
+        }
+        std::vector<uint8_t> entries(blocks*HUFFMAN_INDEX_ENTRY_BYTES);
+        if(fread(entries.data(), 1, entries.size(), in) != entries.size()) {
+            return false;
+        }
+        offsets.clear();
+        positions.clear();
+        for(uint64_t b = 0; b < blocks; ++b) {
+            offsets.push_back(get_u64(&entries[b*HUFFMAN_INDEX_ENTRY_BYTES]));
+            positions.push_back(get_u64(&entries[b*HUFFMAN_INDEX_ENTRY_BYTES + 8]));
+            if(offsets[b] > index || (b == 0 && (positions[b] != 0 ||
+                                                 offsets[b] < sizeof(header))) ||
+               (b > 0 && (offsets[b] < offsets[b - 1] ||
+                          positions[b] < positions[b - 1]))) {
+                return false;
+            }
+        }
+        offsets.push_back(index);
+        return true;
+    }
+
+    /* Whether block 'b' decoding to 'size' bytes agrees with the index:
+     * every block but the last one ends where the next one starts, and
+     * the last one holds at most a block's worth of bytes. */
+    static bool block_size_ok(const std::vector<uint64_t>& positions,
+                              size_t b, uint64_t block_bytes, size_t size) {
+        if(b + 1 < positions.size()) {
+            return size == positions[b + 1] - positions[b];
+        }
+        return b < positions.size() && size > 0 && size <= block_bytes;
+    }
+
+public:
+    block_compressor(int num_threads = std::thread::hardware_concurrency(),
+                     size_t _block_size = HUFFMAN_BLOCK_SIZE) :
+        jobs(), finished(), workers(), block_size(_block_size)
+    {
+        /* The header stores the block size in 4 bytes, and empty blocks
+         * would never reach the end of the input */
+        block_size = std::min<size_t>(std::max<size_t>(block_size, 1),
+                                      UINT32_MAX);
+        num_threads = num_threads < 1 ? 1 : num_threads;
+        for(int i = 0; i < num_threads; ++i) {
+            workers.push_back(std::thread(&block_compressor::work, this));
+        }
+    }
+
+    block_compressor(const block_compressor&) = delete;
+    block_compressor& operator=(const block_compressor&) = delete;
+
+    /* Compresses the file at 'in_path' into 'out_path'. */
+    bool compress_file(const char* in_path, const char* out_path) {
+        FILE* in = fopen(in_path, "rb");
+        FILE* out = in ? fopen(out_path, "wb") : NULL;
+        if(!out) {
+            if(in) {
+                fclose(in);
+            }
+            return false;
+        }
+
+        std::vector<uint8_t> index;
+        uint64_t written = 0, position = 0;
+        std::vector<uint8_t> header(HUFFMAN_STREAM_MAGIC,
+                                    HUFFMAN_STREAM_MAGIC + 4);
+        for(int i = 0; i < 4; ++i) {
+            header.push_back(block_size >> 8*i);
+        }
+        bool ok = fwrite(header.data(), 1, header.size(), out) == header.size();
+        written = header.size();
+
+        ok = ok && run(true, [&](std::vector<uint8_t>& block, bool& more) {
+            block.resize(block_size);
+            block.resize(fread(block.data(), 1, block_size, in));
+            more = block.size() == block_size;
+            return !ferror(in);
+        }, [&](const std::vector<uint8_t>& blob) {
+            put_u64(index, written);
+            put_u64(index, position);
+            position += get_u64(blob.data());
+            written += blob.size();
+            return fwrite(blob.data(), 1, blob.size(), out) == blob.size();
+        });
+
+        if(ok) {
+            put_u64(index, written);
+            put_u64(index, index.size()/HUFFMAN_INDEX_ENTRY_BYTES);
+            index.insert(index.end(), HUFFMAN_STREAM_MAGIC,
+                         HUFFMAN_STREAM_MAGIC + 4);
+            ok = fwrite(index.data(), 1, index.size(), out) == index.size();
+        }
+        fclose(in);
+        ok = fclose(out) == 0 && ok;
+        return ok;
+    }
+
+    /* Restores a file written by compress_file(). */
+    bool decompress_file(const char* in_path, const char* out_path) {
+        FILE* in = fopen(in_path, "rb");
+        std::vector<uint64_t> offsets, positions;
+        uint64_t block_bytes;
+        if(!in || !read_index(in, offsets, positions, block_bytes)) {
+            if(in) {
+                fclose(in);
+            }
+            return false;
+        }
+        FILE* out = fopen(out_path, "wb");
+        if(!out) {
+            fclose(in);
+            return false;
+        }
+
+        size_t next = 0, decoded = 0;
+        bool ok = offsets.size() == 1 ||
+                  fseeko(in, offsets[0], SEEK_SET) == 0;
+        ok = ok && run(false, [&](std::vector<uint8_t>& blob, bool& more) {
+            more = next + 2 < offsets.size();
+            if(next + 1 >= offsets.size()) {
+                return true;
+            }
+            blob.resize(offsets[next + 1] - offsets[next]);
+            ++next;
+            return blob.size() >= HUFFMAN_HEADER_BYTES &&
+                   fread(blob.data(), 1, blob.size(), in) == blob.size();
+        }, [&](const std::vector<uint8_t>& block) {
+            return block_size_ok(positions, decoded++, block_bytes,
+                                 block.size()) &&
+                   fwrite(block.data(), 1, block.size(), out) == block.size();
+        });
+        fclose(in);
+        ok = fclose(out) == 0 && ok;
+        return ok;
+    }
+
+    /*
+     * Decompresses only the block that holds byte 'position' of the
+     * original file, on the calling thread. 'first' is set to the original
+     * position of the block's first byte. Fails if 'position' is past the
+     * end of the original file.
+     */
+    static bool read_block(const char* path, uint64_t position,
+                           std::vector<uint8_t>& out, uint64_t& first) {
+        FILE* in = fopen(path, "rb");
+        std::vector<uint64_t> offsets, positions;
+        uint64_t block_bytes;
+        if(!in || !read_index(in, offsets, positions, block_bytes) ||
+           positions.empty() || position >= positions.back() + block_bytes) {
+            if(in) {
+                fclose(in);
+            }
+            return false;
+        }
+        /* positions[0] is 0, so some block starts at or before 'position' */
+        size_t b = std::upper_bound(positions.begin(), positions.end(),
+                                    position) - positions.begin() - 1;
+        std::vector<uint8_t> blob(offsets[b + 1] - offsets[b]);
+        bool ok = fseeko(in, offsets[b], SEEK_SET) == 0 &&
+                  fread(blob.data(), 1, blob.size(), in) == blob.size();
+        fclose(in);
+        first = positions[b];
+        out.clear();
+        /* The last block may end before 'position' */
+        return ok && canonical_huffman::decompress(blob.data(), blob.size(),
+                                                   out) &&
+               block_size_ok(positions, b, block_bytes, out.size()) &&
+               position - first < out.size();
+    }
+
+    int threads() const {
+        return workers.size();
+    }
+
+    ~block_compressor() {
+        jobs.close();
+        for(std::thread& t : workers) {
+            t.join();
+        }
+    }
+};
+
+#endif /* _BLOCK_COMPRESSOR_H_ */
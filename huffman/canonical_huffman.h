@@ -0,0 +1,316 @@
+#ifndef _CANONICAL_HUFFMAN_H_
+#define _CANONICAL_HUFFMAN_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "huffman.h"
+#include "histogram.h"
+
+#define HUFFMAN_MAX_CODE_LENGTH 15
+/* Two code lengths per byte, one for each of the 256 byte values */
+#define HUFFMAN_LENGTHS_BYTES 128
+/* Original size (8 bytes, little endian), then the code lengths */
+#define HUFFMAN_HEADER_BYTES (8 + HUFFMAN_LENGTHS_BYTES)
+
+/*
+ * Canonical Huffman code over bytes, with codes of at most
+ * HUFFMAN_MAX_CODE_LENGTH bits. In a canonical code the codes follow from
+ * the lengths alone (shorter codes first, ties by byte value), so the
+ * lengths are all a decoder needs: they fit in a fixed 128-byte header,
+ * and the decoding tables are rebuilt from them without any tree.
+ *
+ * Lengths come from package-merge, which finds the optimal code under
+ * the length limit. Bits are packed LSB first as in Huffman::encode(), so
+ * the codes are stored bit-reversed.
+ */
+class canonical_huffman {
+    struct package {
+        uint64_t weight;
+        int symbol; /* -1 for a package of two items of the level below */
+        int first; /* index of the first of those two items */
+    };
+
+    uint8_t lengths[256];
+    uint16_t codes[256];
+    /* Number of codes of each length, and the symbols sorted by code */
+    int length_count[HUFFMAN_MAX_CODE_LENGTH + 1];
+    uint8_t sorted_symbols[256];
+    /* Same layout as Huffman::lookup; 0 for codes longer than the table */
+    std::vector<uint16_t> lookup;
+
+    void count_leaves(const std::vector<std::vector<package> >& levels,
+                      int level, int idx) {
+        const package& p = levels[level][idx];
+        if(p.symbol >= 0) {
+            ++lengths[p.symbol];
+        } else {
+            count_leaves(levels, level - 1, p.first);
+            count_leaves(levels, level - 1, p.first + 1);
+        }
+    }
+
+    /*
+     * Package-merge: level 0 holds the symbols sorted by count. Each
+     * following level merges the symbols again with the items of the level
+     * below paired up into packages. A symbol's code length is the number
+     * of times it shows up in the cheapest 2n - 2 items of the last level.
+     */
+    void limit_lengths(const uint64_t counts[256]) {
+        std::vector<package> leaves;
+        for(int b = 0; b < 256; ++b) {
+            lengths[b] = 0;
+            if(counts[b]) {
+                leaves.push_back(package{counts[b], b, 0});
+            }
+        }
+        if(leaves.size() == 1) {
+            lengths[leaves[0].symbol] = 1;
+            return;
+        }
+        std::stable_sort(leaves.begin(), leaves.end(),
+                         [](const package& a, const package& b) {
+            return a.weight < b.weight;
+        });
+
+        std::vector<std::vector<package> > levels(1, leaves);
+        for(int level = 1; level < HUFFMAN_MAX_CODE_LENGTH; ++level) {
+            const std::vector<package>& below = levels.back();
+            std::vector<package> merged;
+            size_t leaf = 0, pair = 0;
+            while(leaf < leaves.size() || pair + 1 < below.size()) {
+                if(pair + 1 >= below.size() ||
+                   (leaf < leaves.size() && leaves[leaf].weight <=
+                    below[pair].weight + below[pair + 1].weight)) {
+                    merged.push_back(leaves[leaf++]);
+                } else {
+                    merged.push_back(package{below[pair].weight +
+                                             below[pair + 1].weight,
+                                             -1, (int)pair});
+                    pair += 2;
+                }
+            }
+            levels.push_back(merged);
+        }
+        for(size_t i = 0; i + 2 < 2*leaves.size(); ++i) {
+            count_leaves(levels, levels.size() - 1, i);
+        }
+    }
+
+    /* Assigns canonical codes and builds the decoding tables. Returns false
+     * if the lengths do not describe a prefix code. */
+    bool assign_codes() {
+        for(int l = 0; l <= HUFFMAN_MAX_CODE_LENGTH; ++l) {
+            length_count[l] = 0;
+        }
+        for(int b = 0; b < 256; ++b) {
+            if(lengths[b] > HUFFMAN_MAX_CODE_LENGTH) {
+                return false;
+            }
+            ++length_count[lengths[b]];
+        }
+        /* Kraft's inequality: the codes must not need more than the
+         * 2^max codes of maximum length there are */
+        long available = 1;
+        for(int l = 1; l <= HUFFMAN_MAX_CODE_LENGTH; ++l) {
+            available = 2*available - length_count[l];
+            if(available < 0) {
+                return false;
+            }
+        }
+
+        int next_code[HUFFMAN_MAX_CODE_LENGTH + 1];
+        int offset[HUFFMAN_MAX_CODE_LENGTH + 1];
+        int code = 0, symbols = 0;
+        length_count[0] = 0;
+        for(int l = 1; l <= HUFFMAN_MAX_CODE_LENGTH; ++l) {
+            code = (code + length_count[l - 1]) << 1;
+            next_code[l] = code;
+            offset[l] = symbols;
+            symbols += length_count[l];
+        }
+
+        lookup.assign(1 << HUFFMAN_LOOKUP_BITS, 0);
+        for(int b = 0; b < 256; ++b) {
+            int l = lengths[b];
+            codes[b] = 0;
+            if(l == 0) {
+                continue;
+            }
+            sorted_symbols[offset[l]++] = b;
+            int c = next_code[l]++;
+            for(int i = 0; i < l; ++i) {
+                codes[b] |= (c >> (l - 1 - i) & 1) << i;
+            }
+            if(l <= HUFFMAN_LOOKUP_BITS) {
+                for(int rest = 0; rest < 1 << (HUFFMAN_LOOKUP_BITS - l);
+                    ++rest) {
+                    lookup[codes[b] | rest << l] = b | l << 8;
+                }
+            }
+        }
+        return true;
+    }
+
+    /* Decodes one code longer than the lookup table from the bits at the
+     * bottom of 'buffer', one length at a time, using only the counts per
+     * length. Returns the code length, or 0 if no code matches. */
+    int decode_slow(uint64_t buffer, uint8_t& symbol) const {
+        int code = 0, first = 0, index = 0;
+        for(int l = 1; l <= HUFFMAN_MAX_CODE_LENGTH; ++l) {
+            code |= buffer >> (l - 1) & 1;
+            if(code - first < length_count[l]) {
+                symbol = sorted_symbols[index + code - first];
+                return l;
+            }
+            index += length_count[l];
+            first = (first + length_count[l]) << 1;
+            code <<= 1;
+        }
+        return 0;
+    }
+
+public:
+    canonical_huffman() : lookup() {
+        uint64_t counts[256] = {0};
+        build(counts);
+    }
+
+    /* Code for bytes that occur counts[b] times. */
+    explicit canonical_huffman(const uint64_t counts[256]) : lookup() {
+        build(counts);
+    }
+
+    void build(const uint64_t counts[256]) {
+        limit_lengths(counts);
+        assign_codes();
+    }
+
+    /* Code with the given lengths; false if they are not a valid code. */
+    bool set_lengths(const uint8_t _lengths[256]) {
+        std::copy(_lengths, _lengths + 256, lengths);
+        return assign_codes();
+    }
+
+    int code_length(uint8_t b) const {
+        return lengths[b];
+    }
+
+    /* Number of bits needed to encode bytes with the given counts. */
+    uint64_t encoded_bits(const uint64_t counts[256]) const {
+        uint64_t bits = 0;
+        for(int b = 0; b < 256; ++b) {
+            bits += counts[b]*lengths[b];
+        }
+        return bits;
+    }
+
+    /* Appends the code lengths, HUFFMAN_LENGTHS_BYTES bytes. */
+    void write_lengths(std::vector<uint8_t>& out) const {
+        for(int b = 0; b < 256; b += 2) {
+            out.push_back(lengths[b] | lengths[b + 1] << 4);
+        }
+    }
+
+    /* Rebuilds the code from lengths written by write_lengths(). */
+    bool read_lengths(const uint8_t* data, size_t n) {
+        if(n < HUFFMAN_LENGTHS_BYTES) {
+            return false;
+        }
+        for(int b = 0; b < 256; b += 2) {
+            lengths[b] = data[b/2] & 0xf;
+            lengths[b + 1] = data[b/2] >> 4;
+        }
+        return assign_codes();
+    }
+
+    /* Same as Huffman::encode(); bytes without a code are skipped. */
+    void encode(const uint8_t* data, size_t n,
+                std::vector<uint8_t>& out) const {
+        size_t pos = out.size();
+        out.resize(pos + n/2 + 8);
+        uint64_t buffer = 0;
+        int count = 0;
+        for(size_t i = 0; i < n; ++i) {
+            buffer |= (uint64_t)codes[data[i]] << count;
+            count += lengths[data[i]];
+            write_word(out, pos, buffer, count);
+        }
+        for(; count > 0; count -= 8, buffer >>= 8) {
+            out[pos++] = buffer;
+        }
+        out.resize(pos);
+    }
+
+    /* Same as Huffman::decode(). */
+    bool decode(const uint8_t* data, size_t n, size_t symbols,
+                std::vector<uint8_t>& out) const {
+        const uint8_t* end = data + n;
+        uint64_t buffer = 0;
+        int count = 0;
+        size_t pos = out.size();
+        out.resize(pos + symbols);
+        uint8_t* dst = out.data() + pos;
+        for(size_t i = 0; i < symbols; ++i) {
+            if(count < 56) {
+                refill(data, end, buffer, count);
+            }
+            uint16_t entry = lookup[buffer & ((1 << HUFFMAN_LOOKUP_BITS) - 1)];
+            int length = entry >> 8;
+            if(length) {
+                dst[i] = entry;
+            } else {
+                length = decode_slow(buffer, dst[i]);
+            }
+            if(length == 0 || length > count) {
+                out.resize(pos + i);
+                return false;
+            }
+            buffer >>= length;
+            count -= length;
+        }
+        return true;
+    }
+
+    /*
+     * Self-contained blob: original size, code lengths, then the packed
+     * codes (see HUFFMAN_HEADER_BYTES). Appended to 'out'.
+     */
+    static void compress(const uint8_t* data, size_t n,
+                         std::vector<uint8_t>& out) {
+        uint64_t counts[256];
+        byte_histogram(data, n, counts);
+        canonical_huffman code(counts);
+        for(int i = 0; i < 8; ++i) {
+            out.push_back((uint64_t)n >> 8*i);
+        }
+        code.write_lengths(out);
+        code.encode(data, n, out);
+    }
+
+    /* Appends the bytes of a blob made by compress() to 'out'. Returns
+     * false if the blob is truncated or malformed. */
+    static bool decompress(const uint8_t* data, size_t n,
+                           std::vector<uint8_t>& out) {
+        if(n < HUFFMAN_HEADER_BYTES) {
+            return false;
+        }
+        uint64_t size = 0;
+        for(int i = 0; i < 8; ++i) {
+            size |= (uint64_t)data[i] << 8*i;
+        }
+        canonical_huffman code;
+        if(!code.read_lengths(data + 8, n - 8)) {
+            return false;
+        }
+        /* Every code is at least one bit long */
+        if(size > 8*(uint64_t)(n - HUFFMAN_HEADER_BYTES)) {
+            return false;
+        }
+        return code.decode(data + HUFFMAN_HEADER_BYTES,
+                           n - HUFFMAN_HEADER_BYTES, size, out);
+    }
+};
+
+#endif /* _CANONICAL_HUFFMAN_H_ */
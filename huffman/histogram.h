@@ -0,0 +1,51 @@
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define HISTOGRAM_TABLES 4
+/* Bytes per pass, small enough that no 32-bit counter can overflow */
+#define HISTOGRAM_CHUNK ((size_t)1 << 30)
+
+/*
+ * Counts how many times every byte value occurs in data[0, n) into
+ * counts[256]. Runs of equal bytes are common, and incrementing the same
+ * counter back to back makes each increment wait for the previous store.
+ * So consecutive bytes go to HISTOGRAM_TABLES separate tables, which are
+ * added up at the end. Input is read 8 bytes at a time.
+ */
+inline void byte_histogram(const uint8_t* data, size_t n, uint64_t counts[256]) {
+    uint32_t tables[HISTOGRAM_TABLES][256];
+    for(int b = 0; b < 256; ++b) {
+        counts[b] = 0;
+    }
+    while(n > 0) {
+        size_t chunk = n < HISTOGRAM_CHUNK ? n : HISTOGRAM_CHUNK;
+        memset(tables, 0, sizeof(tables));
+        size_t i = 0;
+        for(; i + 8 <= chunk; i += 8) {
+            uint64_t word;
+            memcpy(&word, data + i, 8);
+            ++tables[0][word & 0xff];
+            ++tables[1][word >> 8 & 0xff];
+            ++tables[2][word >> 16 & 0xff];
+            ++tables[3][word >> 24 & 0xff];
+            ++tables[0][word >> 32 & 0xff];
+            ++tables[1][word >> 40 & 0xff];
+            ++tables[2][word >> 48 & 0xff];
+            ++tables[3][word >> 56];
+        }
+        for(; i < chunk; ++i) {
+            ++tables[0][data[i]];
+        }
+        for(int b = 0; b < 256; ++b) {
+            counts[b] += (uint64_t)tables[0][b] + tables[1][b] +
+                         tables[2][b] + tables[3][b];
+        }
+        data += chunk;
+        n -= chunk;
+    }
+}
+
+#endif /* _HISTOGRAM_H_ */
@@ -1,144 +1,72 @@
-#include <iostream>
-#include <unordered_map>
+#include <fstream>
+#include <iterator>
+
+#include "huffman.h"
+#include "canonical_huffman.h"
+#include "block_compressor.h"
+#include "histogram.h"
+
+void get_chars_and_freq(const string& message, vector<char>& chars, vector<int>& freq) {
+    uint64_t counts[256];
+    byte_histogram((const uint8_t*)message.data(), message.size(), counts);
+
+    for(int b = 0; b < 256; ++b) {
+        if(counts[b]) {
+            chars.push_back(b);
+            freq.push_back(counts[b]);
+        }
+    }
+}
 
-#include "../heap/my_heap.h"
+/* Compresses the file at 'path' into packed bits and back, and checks that
+ * the bytes survive the round trip. */
+int round_trip(const char* path) {
+    ifstream in(path, ios::binary);
+    if(!in) {
+        printf("Cannot open %s\n", path);
+        return 1;
+    }
+    string message((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
 
-using namespace std;
+    vector<char> chars;
+    vector<int>  freq;
+    get_chars_and_freq(message, chars, freq);
+    Huffman huff(chars, freq);
 
-struct node {
-    char c;
-    int freq;
-    node* left;
-    node* right;
+    vector<uint8_t> packed, unpacked;
+    huff.encode((const uint8_t*)message.data(), message.size(), packed);
+    bool ok = huff.decode(packed.data(), packed.size(), message.size(), unpacked) &&
+              equal(unpacked.begin(), unpacked.end(), message.begin(),
+                    [](uint8_t a, char b) { return a == (uint8_t)b; });
+    printf("%zu bytes -> %zu bytes, %s\n", message.size(), packed.size(),
+           ok ? "round trip OK" : "round trip FAILED");
+
+    /* Canonical code, stored with its code lengths */
+    vector<uint8_t> blob, restored;
+    canonical_huffman::compress((const uint8_t*)message.data(), message.size(), blob);
+    bool canonical_ok = canonical_huffman::decompress(blob.data(), blob.size(), restored) &&
+                        string(restored.begin(), restored.end()) == message;
+    printf("%zu bytes -> %zu bytes with header, %s\n", message.size(), blob.size(),
+           canonical_ok ? "round trip OK" : "round trip FAILED");
+    return ok && canonical_ok ? 0 : 1;
+}
 
-    node() : c(-1), freq(0), left(nullptr), right(nullptr) {}
-    node(const int& _fq) : c(-1), freq(_fq), left(nullptr), right(nullptr) {}
-    node(const char& _c, const int& _fq) : c(_c), freq(_fq), left(nullptr), right(nullptr) {}
-};
 
-struct node_compare { 
-    bool operator()(node* lhs, node* rhs) {
-        return lhs->freq < rhs->freq;
-    }
-};
+int main(int argc, char* argv[]) {
 
-class Huffman {
-    node* root;
-    my_heap<node*, node_compare> h;
-    vector<char> chars;
-    vector<int> freq;
-    unordered_map<char, string> code;
-    void build_heap() {
-        for(int i = 0; i < chars.size(); ++i) {
-            node* n = new node(chars[i], freq[i]);
-            h.push(n);
-        }
-    }
-    void create_codes(string str, node* n) {
-        if(n->left) {
-            create_codes(str + "0", n->left);
-        }
-        if(n->right) {
-            create_codes(str + "1", n->right);
-        }
-        if(!n->left && !n->right) {
-            code[n->c] = str; 
+    /* huffman -c|-d <in> <out> [threads]: block (de)compression of files */
+    if(argc > 3 && (string(argv[1]) == "-c" || string(argv[1]) == "-d")) {
+        block_compressor blocks(argc > 4 ? atoi(argv[4]) : thread::hardware_concurrency());
+        bool ok = argv[1][1] == 'c' ? blocks.compress_file(argv[2], argv[3])
+                                    : blocks.decompress_file(argv[2], argv[3]);
+        if(!ok) {
+            printf("Cannot %s %s\n", argv[1][1] == 'c' ? "compress" : "decompress", argv[2]);
         }
+        return ok ? 0 : 1;
     }
-    void build_tree() {
-        while(h.size() > 1) {
-            node* l = h.top();
-            h.pop();
-            node* r = h.top();
-            h.pop();
-            node* n = new node(l->freq + r->freq);
-            n->left  = l;
-            n->right = r;
-            h.push(n);
-        }
-        if(h.empty()) { printf(" ** Something went wrong... **\n"); }
-        else {
-            root = h.top();
-        }
+    if(argc > 1) {
+        return round_trip(argv[1]);
     }
-    char code_to_char(const string& str, int& idx) const {
-        char c = -1;
-        node* n = root;
-        while(n) {
-            if(n->c != -1) {
-                c = n->c;
-                break;
-            }
-            else if(str[idx] == '0') {
-                n = n->left;
-            }
-            else if(str[idx] == '1') {
-                n = n->right;
-            }
-            ++idx;
-        }
-        return c;
-    }
-    void delete_tree(node* n) {
-        if(n->left) {
-            delete_tree(n->left);
-        }
-        if(n->right) {
-            delete_tree(n->right);
-        }
-        delete n;
-    }
-public:
-    Huffman() : root(nullptr), h(), chars(), freq(), code() {}
-    Huffman(vector<char> _chars, vector<int> _freq) : root(nullptr), h(), chars(_chars), freq(_freq), code() {
-        build_heap();
-        build_tree();
-        create_codes("", root);
-    }
-    void print_codes() const {
-        printf(" char | code\n");
-        for(auto it : code) {
-            printf("  \'%c\' - %s\n", it.first, it.second.c_str());
-        }
-    }
-    string encode(const string& message) {
-        string result = "";
-        for(char c : message) {
-            if(code.find(c) != code.end()) {
-                result += code[c];
-            }
-        }
-        return result;
-    }
-    string decode(const string& message) const {
-        string result = "";
-        int i = 0;
-        while(i < message.size()) {
-            char c = code_to_char(message, i);
-            result.push_back(c);
-        }
-        return result;
-    }
-    ~Huffman() {
-        delete_tree(root);
-    }
-};
-
-vector<int> get_chars_and_freq(const string& message, vector<char>& chars, vector<int>& freq) {
-    unordered_map<char, int> m;
-
-    for(char c : message) { 
-        ++m[c];
-    }
-
-    for(auto it : m) {
-        chars.push_back(it.first);
-        freq.push_back(it.second);
-    }
-}
-
-
-int main() {
 
     string message;
     printf("Enter message to encode: ");
@@ -156,4 +84,4 @@ int main() {
     printf("Decoded message: %s\n", huff.decode(e_message).c_str());
 
     return 0;
-}
\ No newline at end of file
+}
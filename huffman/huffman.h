@@ -0,0 +1,274 @@
+#ifndef _HUFFMAN_H_
+#define _HUFFMAN_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#define HUFFMAN_LOOKUP_BITS 11
+
+using namespace std;
+
+/* Writes out 32 bits once the buffer holds that many. */
+inline void write_word(vector<uint8_t>& out, size_t& pos,
+                       uint64_t& buffer, int& count) {
+    if(count < 32) {
+        return;
+    }
+    if(pos + 4 > out.size()) {
+        out.resize(2*out.size() + 8);
+    }
+    out[pos] = buffer;
+    out[pos + 1] = buffer >> 8;
+    out[pos + 2] = buffer >> 16;
+    out[pos + 3] = buffer >> 24;
+    pos += 4;
+    buffer >>= 32;
+    count -= 32;
+}
+
+/* Tops 'buffer' up to at least 56 bits while there is input left.
+ * Away from the end, one unaligned 8-byte load does it: the bits it
+ * puts above 'count' are the next input bits anyway, so OR-ing them in
+ * again on the next refill changes nothing (assumes little endian). */
+inline void refill(const uint8_t*& p, const uint8_t* end,
+                   uint64_t& buffer, int& count) {
+    if(end - p >= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        buffer |= word << count;
+        p += (63 - count) >> 3;
+        count |= 56;
+        return;
+    }
+    while(count <= 56 && p < end) {
+        buffer |= (uint64_t)*p++ << count;
+        count += 8;
+    }
+}
+
+struct node {
+    char c;
+    int freq;
+    node* left;
+    node* right;
+
+    node() : c(-1), freq(0), left(nullptr), right(nullptr) {}
+    node(const int& _fq) : c(-1), freq(_fq), left(nullptr), right(nullptr) {}
+    node(const char& _c, const int& _fq) : c(_c), freq(_fq), left(nullptr), right(nullptr) {}
+};
+
+class Huffman {
+    node* root;
+    /* Leaves sorted by frequency, then the internal nodes in the order
+     * they were made; reserved up front so the node pointers stay valid */
+    vector<node> nodes;
+    vector<char> chars;
+    vector<int> freq;
+    unordered_map<char, string> code;
+    /* Packed codes: bit i of code_bits[b] is the i-th bit of the code of
+     * byte b, so codes can be OR-ed straight into an LSB-first buffer */
+    uint64_t code_bits[256];
+    uint8_t code_length[256];
+    /* Decoding table indexed by the next HUFFMAN_LOOKUP_BITS bits: the
+     * symbol in the low byte and its code length above it, or 0 for codes
+     * longer than the table, which are resolved by walking the tree */
+    vector<uint16_t> lookup;
+    void create_codes(string str, node* n) {
+        if(n->left) {
+            create_codes(str + "0", n->left);
+        }
+        if(n->right) {
+            create_codes(str + "1", n->right);
+        }
+        if(!n->left && !n->right) {
+            /* A lone symbol still needs one bit per occurrence */
+            code[n->c] = str.empty() ? "0" : str;
+        }
+    }
+    void build_tables() {
+        lookup.assign(1 << HUFFMAN_LOOKUP_BITS, 0);
+        for(int b = 0; b < 256; ++b) {
+            code_bits[b] = 0;
+            code_length[b] = 0;
+        }
+        for(auto it : code) {
+            uint8_t b = it.first;
+            for(size_t i = 0; i < it.second.size(); ++i) {
+                code_bits[b] |= (uint64_t)(it.second[i] == '1') << i;
+            }
+            code_length[b] = it.second.size();
+            if(code_length[b] <= HUFFMAN_LOOKUP_BITS) {
+                for(uint64_t rest = 0;
+                    rest < (1u << (HUFFMAN_LOOKUP_BITS - code_length[b]));
+                    ++rest) {
+                    lookup[code_bits[b] | rest << code_length[b]] =
+                        b | code_length[b] << 8;
+                }
+            }
+        }
+    }
+    /*
+     * Two-queue construction: with the leaves sorted by frequency, every
+     * merged node is at least as heavy as the one merged before it, so the
+     * internal nodes come out sorted too. The two lightest nodes are then
+     * always at the front of one of the two runs, and the whole tree takes
+     * O(n) after the sort, with no heap and no allocation per node.
+     */
+    void build_tree() {
+        size_t n = chars.size();
+        nodes.clear();
+        nodes.reserve(2*n);
+        for(size_t i = 0; i < n; ++i) {
+            nodes.push_back(node(chars[i], freq[i]));
+        }
+        stable_sort(nodes.begin(), nodes.end(), [](const node& a, const node& b) {
+            return a.freq < b.freq;
+        });
+
+        size_t leaf = 0, merged = n;
+        auto lightest = [&]() {
+            if(leaf < n && (merged == nodes.size() || nodes[leaf].freq <= nodes[merged].freq)) {
+                return &nodes[leaf++];
+            }
+            return &nodes[merged++];
+        };
+        for(size_t i = 1; i < n; ++i) {
+            node* l = lightest();
+            node* r = lightest();
+            nodes.push_back(node(l->freq + r->freq));
+            nodes.back().left  = l;
+            nodes.back().right = r;
+        }
+        if(nodes.empty()) { printf(" ** Something went wrong... **\n"); }
+        else {
+            root = &nodes.back();
+        }
+    }
+    /* Leaves are told apart by having no children, not by 'c', since any
+     * byte, including (char)-1, can be a symbol. */
+    char code_to_char(const string& str, int& idx) const {
+        node* n = root;
+        while(n->left || n->right) {
+            n = str[idx] == '1' ? n->right : n->left;
+            ++idx;
+        }
+        if(n == root) {
+            ++idx;
+        }
+        return n->c;
+    }
+public:
+    Huffman() : root(nullptr), nodes(), chars(), freq(), code(), lookup() {}
+    Huffman(vector<char> _chars, vector<int> _freq) : root(nullptr), nodes(), chars(_chars), freq(_freq), code(), lookup() {
+        build_tree();
+        if(root) {
+            create_codes("", root);
+        }
+        build_tables();
+    }
+    void print_codes() const {
+        printf(" char | code\n");
+        for(auto it : code) {
+            printf("  \'%c\' - %s\n", it.first, it.second.c_str());
+        }
+    }
+    string encode(const string& message) {
+        string result = "";
+        for(char c : message) {
+            if(code.find(c) != code.end()) {
+                result += code[c];
+            }
+        }
+        return result;
+    }
+    string decode(const string& message) const {
+        string result = "";
+        int i = 0;
+        while(i < message.size()) {
+            char c = code_to_char(message, i);
+            result.push_back(c);
+        }
+        return result;
+    }
+    /*
+     * Appends the codes of data[0, n) to 'out', packed 8 per byte starting
+     * from the least significant bit; the last byte is padded with zeros.
+     * Bytes without a code are skipped, like in encode().
+     */
+    void encode(const uint8_t* data, size_t n, vector<uint8_t>& out) const {
+        size_t pos = out.size();
+        out.resize(pos + n/2 + 8);
+        uint64_t buffer = 0;
+        int count = 0;
+        for(size_t i = 0; i < n; ++i) {
+            uint64_t bits = code_bits[data[i]];
+            int length = code_length[data[i]];
+            /* Codes fit in 64 bits, but the buffer only takes 32 at once */
+            if(length > 32) {
+                buffer |= (bits & 0xffffffff) << count;
+                bits >>= 32;
+                length -= 32;
+                count += 32;
+                write_word(out, pos, buffer, count);
+            }
+            buffer |= bits << count;
+            count += length;
+            write_word(out, pos, buffer, count);
+        }
+        for(; count > 0; count -= 8, buffer >>= 8) {
+            out[pos++] = buffer;
+        }
+        out.resize(pos);
+    }
+
+    /*
+     * Decodes 'symbols' bytes from the packed bits in data[0, n) and
+     * appends them to 'out'. Returns false if the bits run out first.
+     */
+    bool decode(const uint8_t* data, size_t n, size_t symbols,
+                vector<uint8_t>& out) const {
+        const uint8_t* end = data + n;
+        uint64_t buffer = 0;
+        int count = 0;
+        size_t pos = out.size();
+        out.resize(pos + symbols);
+        uint8_t* dst = out.data() + pos;
+        for(size_t i = 0; i < symbols; ++i) {
+            if(count < 56) {
+                refill(data, end, buffer, count);
+            }
+            uint16_t entry = lookup[buffer & ((1 << HUFFMAN_LOOKUP_BITS) - 1)];
+            int length = entry >> 8;
+            if(length) {
+                dst[i] = entry;
+            } else {
+                node* n = root;
+                for(length = 0; n && (n->left || n->right); ++length) {
+                    n = buffer >> length & 1 ? n->right : n->left;
+                }
+                if(!n) {
+                    out.resize(pos + i);
+                    return false;
+                }
+                dst[i] = n->c;
+            }
+            if(length > count) {
+                out.resize(pos + i);
+                return false;
+            }
+            buffer >>= length;
+            count -= length;
+        }
+        return true;
+    }
+
+    /* The nodes point into 'nodes', so a copy would point into ours */
+    Huffman(const Huffman&) = delete;
+    Huffman& operator=(const Huffman&) = delete;
+};
+
+#endif /* _HUFFMAN_H_ */
@@ -0,0 +1,73 @@
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <chrono> /* steady_clock */
+#include <thread> /* hardware_concurrency */
+#include <vector> /* vector */
+
+#include "csr_graph.h"
+
+#define MAX_WEIGHT 1000000
+#define MAX_THREADS 16
+
+/* Random graph made of 'parts' connected pieces of equal size: a random
+ * spanning tree inside each piece plus random edges within the pieces. */
+std::vector<edge> random_edges(int vertices, long num_edges, int parts) {
+    std::vector<edge> edges;
+    int part_size = vertices / parts;
+    edges.reserve(num_edges);
+    for(int v = 0; v < vertices; ++v) {
+        int first = v / part_size * part_size;
+        if(v > first) {
+            edges.push_back(edge(first + std::rand() % (v - first), v,
+                                 std::rand() % MAX_WEIGHT));
+        }
+    }
+    while((long)edges.size() < num_edges) {
+        int first = std::rand() % parts * part_size;
+        int u = first + std::rand() % part_size;
+        int v = first + std::rand() % part_size;
+        if(u != v) {
+            edges.push_back(edge(u, v, std::rand() % MAX_WEIGHT));
+        }
+    }
+    return edges;
+}
+
+template<typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/* Runs Prim's once and Borůvka on 1 to MAX_THREADS threads, checking that
+ * every forest has the same weight and number of edges. */
+void report(const char* name, int vertices, long num_edges, int parts) {
+    csr_graph g(vertices, random_edges(vertices, num_edges, parts));
+    std::vector<edge> mst;
+    long long weight = 0;
+    double prims = seconds([&] { weight = g.prims(mst); });
+    size_t forest_size = mst.size();
+    bool same = forest_size == (size_t)(vertices - parts);
+
+    printf("%-13s prims %6.3fs  boruvka", name, prims);
+    double single = 0;
+    for(int n = 1; n <= MAX_THREADS; n <<= 1) {
+        long long boruvka_weight = 0;
+        double secs = seconds([&] { boruvka_weight = g.boruvka(mst, n); });
+        single = n == 1 ? secs : single;
+        same = same && boruvka_weight == weight && mst.size() == forest_size;
+        printf(" %2d: %6.3fs %4.2fx", n, secs, single / secs);
+    }
+    printf("%s\n", same ? "" : "  (results differ!)");
+}
+
+int main() {
+    printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    report("sparse", 1000000, 8000000, 1);
+    report("dense", 4000, 4000000, 1);
+    report("disconnected", 1000000, 8000000, 16);
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <stdio.h> /* printf, fopen */
+#include <stdlib.h> /* rand */
+#include <unistd.h> /* unlink */
+#include <chrono> /* steady_clock */
+#include <vector> /* vector */
+
+#include "csr_graph.h"
+
+#define MAX_WEIGHT 1000000
+#define EDGE_LIST_PATH "/tmp/bench_csr_edges.txt"
+
+/* Connected random graph: a random spanning tree, so every vertex can be
+ * reached, plus random edges up to 'num_edges' in total. */
+std::vector<edge> random_edges(int vertices, long num_edges) {
+    std::vector<edge> edges;
+    edges.reserve(num_edges);
+    for(int v = 1; v < vertices; ++v) {
+        edges.push_back(edge(std::rand() % v, v, std::rand() % MAX_WEIGHT));
+    }
+    while((long)edges.size() < num_edges) {
+        int u = std::rand() % vertices;
+        int v = std::rand() % vertices;
+        if(u != v) {
+            edges.push_back(edge(u, v, std::rand() % MAX_WEIGHT));
+        }
+    }
+    return edges;
+}
+
+template<typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/* Builds the CSR graph and runs Prim's on it; with 'compare' set, also
+ * does the same with the list-based Graph and checks the weights agree. */
+void report(int vertices, long num_edges, bool compare) {
+    std::vector<edge> edges = random_edges(vertices, num_edges);
+    std::vector<edge> mst;
+    csr_graph g;
+    long long weight = 0;
+
+    double build = seconds([&] { g.build(vertices, edges); });
+    double prims = seconds([&] { weight = g.prims(mst); });
+    printf("%9d %9ld %14.0f %14.0f", vertices, num_edges, num_edges / build,
+           num_edges / prims);
+
+    if(compare) {
+        Graph list_graph;
+        double list_build = seconds([&] {
+            for(const edge& e : edges) {
+                list_graph.add_edge(e.u, e.v, e.weight);
+            }
+        });
+        double list_prims = seconds([&] { list_graph.prims_algo_eager(); });
+        printf(" %14.0f %14.0f%s", num_edges / list_build,
+               num_edges / list_prims,
+               list_graph.mst_weight() == weight ? "" : "  (results differ!)");
+    }
+    printf("\n");
+}
+
+/* Writes an edge list to disk and times loading it back. */
+void report_load(int vertices, long num_edges) {
+    std::vector<edge> edges = random_edges(vertices, num_edges);
+    FILE* f = fopen(EDGE_LIST_PATH, "w");
+    if(f == NULL) {
+        printf("cannot write %s\n", EDGE_LIST_PATH);
+        return;
+    }
+    fprintf(f, "# u v weight\n");
+    for(const edge& e : edges) {
+        fprintf(f, "%d %d %d\n", e.u, e.v, e.weight);
+    }
+    fclose(f);
+
+    csr_graph g;
+    bool ok = false;
+    double load = seconds([&] { ok = g.load(EDGE_LIST_PATH); });
+    unlink(EDGE_LIST_PATH);
+    printf("load %ld edges: %.0f edges/s%s\n", num_edges, num_edges / load,
+           ok && g.edges() == num_edges && g.vertices() == vertices ?
+           "" : "  (load failed!)");
+}
+
+int main() {
+    printf("                         CSR edges/s                   list edges/s\n");
+    printf(" vertices     edges          build          prims          build"
+           "          prims\n");
+    report(100000, 1000000, true);
+    report(1000000, 4000000, true);
+    report(1000000, 16000000, false);
+
+    printf("\n");
+    report_load(1000000, 4000000);
+
+    return 0;
+}
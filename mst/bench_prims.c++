@@ -0,0 +1,53 @@
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <chrono> /* steady_clock */
+
+#include "graph.h"
+
+#define MAX_WEIGHT 1000000
+
+/* Connected random graph: a random spanning tree, so every vertex can be
+ * reached, plus 'extra_edges' edges between random vertices. */
+void random_graph(Graph& g, int vertices, long extra_edges) {
+    for(int v = 1; v < vertices; ++v) {
+        g.add_edge(std::rand() % v, v, std::rand() % MAX_WEIGHT);
+    }
+    for(long i = 0; i < extra_edges; ++i) {
+        int u = std::rand() % vertices;
+        int v = std::rand() % vertices;
+        if(u != v) {
+            g.add_edge(u, v, std::rand() % MAX_WEIGHT);
+        }
+    }
+}
+
+template<typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+void report(const char* name, int vertices, long extra_edges) {
+    Graph g;
+    random_graph(g, vertices, extra_edges);
+
+    double lazy = seconds([&] { g.prims_algo(); });
+    long long lazy_weight = g.mst_weight();
+    double eager = seconds([&] { g.prims_algo_eager(); });
+    long long eager_weight = g.mst_weight();
+
+    printf("%-7s %8d %9ld %9.3fs %9.3fs %7.2fx%s\n", name, vertices,
+           vertices - 1 + extra_edges, lazy, eager, lazy / eager,
+           lazy_weight == eager_weight && g.mst_size() == vertices - 1 ?
+           "" : "  (results differ!)");
+}
+
+int main() {
+    printf("graph   vertices     edges      lazy     eager  speedup\n");
+    report("sparse", 200000, 800000);
+    report("dense", 2000, 1000000);
+
+    return 0;
+}
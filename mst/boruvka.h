@@ -0,0 +1,183 @@
+#ifndef _BORUVKA_H_
+#define _BORUVKA_H_
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define BORUVKA_NO_EDGE UINT64_MAX
+
+/* Runs f(thread, begin, end) on 'num_threads' threads, splitting [0, n)
+ * into contiguous chunks, and waits for all of them. */
+template<typename F>
+void parallel_chunks(int num_threads, long n, F f) {
+    if(num_threads <= 1 || n < num_threads) {
+        f(0, 0L, n);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for(int t = 0; t < num_threads; ++t) {
+        threads.push_back(std::thread(f, t, n*t/num_threads,
+                                      n*(t + 1)/num_threads));
+    }
+    for(std::thread& th : threads) {
+        th.join();
+    }
+}
+
+/*
+ * Union-find whose operations are safe to call from many threads at once.
+ * find() halves paths with a CAS, and unite() links one root under the
+ * other with a CAS that fails if the root was linked in the meantime, in
+ * which case it retries from the new roots. Roots always point to smaller
+ * indices, so there are no cycles.
+ */
+class concurrent_union_find {
+    std::vector<std::atomic<int> > parent;
+
+public:
+    explicit concurrent_union_find(int n) : parent(n) {
+        for(int i = 0; i < n; ++i) {
+            parent[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    int find(int x) {
+        int p = parent[x].load(std::memory_order_relaxed);
+        while(p != x) {
+            int gp = parent[p].load(std::memory_order_relaxed);
+            if(gp != p) {
+                parent[x].compare_exchange_weak(p, gp,
+                                                std::memory_order_relaxed);
+            }
+            x = p;
+            p = parent[x].load(std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    /* Joins the sets of 'a' and 'b'; false if they already were one. */
+    bool unite(int a, int b) {
+        for(;;) {
+            a = find(a);
+            b = find(b);
+            if(a == b) {
+                return false;
+            }
+            if(a < b) {
+                std::swap(a, b);
+            }
+            int expected = a;
+            if(parent[a].compare_exchange_strong(expected, b,
+                                                 std::memory_order_acq_rel)) {
+                return true;
+            }
+        }
+    }
+};
+
+/*
+ * Minimum spanning forest of the undirected graph with vertices [0,
+ * vertices) and the given edges (any type with int u, v and weight),
+ * computed with Borůvka's algorithm on 'num_threads' threads. Each round,
+ * every component picks its cheapest outgoing edge, all picked edges are
+ * merged into the forest, and edges inside a component are dropped; it
+ * takes O(log V) rounds. Ties are broken by edge index so the picked
+ * edges never close a cycle. Appends the forest to 'forest' and returns
+ * its total weight.
+ */
+template<typename Edge>
+long long parallel_boruvka(int vertices, const std::vector<Edge>& edges,
+                           std::vector<Edge>& forest, int num_threads) {
+    num_threads = num_threads < 1 ? 1 : num_threads;
+    concurrent_union_find components(vertices);
+    std::vector<std::atomic<uint64_t> > cheapest(vertices);
+    std::vector<uint32_t> alive;
+    std::vector<std::vector<Edge> > picked(num_threads);
+    std::vector<std::pair<long, long> > kept(num_threads);
+    long long total = 0;
+
+    for(uint32_t i = 0; i < edges.size(); ++i) {
+        if(edges[i].u != edges[i].v) {
+            alive.push_back(i);
+        }
+    }
+    for(int v = 0; v < vertices; ++v) {
+        cheapest[v].store(BORUVKA_NO_EDGE, std::memory_order_relaxed);
+    }
+
+    /* Weight in the high half with the sign bit flipped so that unsigned
+     * order matches signed order, edge index in the low half */
+    auto rank = [&](uint32_t i) {
+        return (uint64_t)((uint32_t)edges[i].weight ^ 0x80000000u) << 32 | i;
+    };
+    auto offer = [&](int root, uint64_t r) {
+        uint64_t current = cheapest[root].load(std::memory_order_relaxed);
+        while(r < current &&
+              !cheapest[root].compare_exchange_weak(current, r,
+                                                    std::memory_order_relaxed)) {
+        }
+    };
+
+    while(!alive.empty()) {
+        /* Every component's cheapest edge to another component; edges
+         * already inside a component are left out of the next round */
+        parallel_chunks(num_threads, alive.size(),
+                        [&](int t, long begin, long end) {
+            long out = begin;
+            for(long k = begin; k < end; ++k) {
+                const Edge& e = edges[alive[k]];
+                int ru = components.find(e.u);
+                int rv = components.find(e.v);
+                if(ru != rv) {
+                    uint64_t r = rank(alive[k]);
+                    offer(ru, r);
+                    offer(rv, r);
+                    alive[out++] = alive[k];
+                }
+            }
+            kept[t] = std::make_pair(begin, out);
+        });
+        /* Chunks are in order, so sliding them down is safe */
+        long num_alive = 0;
+        for(std::pair<long, long>& k : kept) {
+            for(long i = k.first; i < k.second; ++i) {
+                alive[num_alive++] = alive[i];
+            }
+            k = std::make_pair(0L, 0L);
+        }
+        alive.resize(num_alive);
+        if(alive.empty()) {
+            break;
+        }
+
+        /* Merge along the picked edges; when two components picked the
+         * same edge, only the first unite() succeeds */
+        parallel_chunks(num_threads, vertices,
+                        [&](int t, long begin, long end) {
+            for(long v = begin; v < end; ++v) {
+                uint64_t r = cheapest[v].load(std::memory_order_relaxed);
+                if(r == BORUVKA_NO_EDGE) {
+                    continue;
+                }
+                cheapest[v].store(BORUVKA_NO_EDGE, std::memory_order_relaxed);
+                const Edge& e = edges[(uint32_t)r];
+                if(components.unite(e.u, e.v)) {
+                    picked[t].push_back(e);
+                }
+            }
+        });
+    }
+
+    for(std::vector<Edge>& p : picked) {
+        for(const Edge& e : p) {
+            forest.push_back(e);
+            total += e.weight;
+        }
+    }
+    return total;
+}
+
+#endif /* _BORUVKA_H_ */
@@ -0,0 +1,202 @@
+#ifndef _CSR_GRAPH_H_
+#define _CSR_GRAPH_H_
+
+#include <fcntl.h> /* open */
+#include <sys/mman.h> /* mmap, munmap */
+#include <sys/stat.h> /* fstat */
+#include <unistd.h> /* close */
+#include <vector>
+
+#include "graph.h"
+
+/*
+ * Undirected weighted graph in compressed sparse row form: the arcs out of
+ * vertex u are arcs[offsets[u]] up to arcs[offsets[u + 1]], one contiguous
+ * array for the whole graph. Every edge is stored once in each direction.
+ * It is built from an edge list with a counting sort (count the degrees,
+ * then drop each edge into place), and never changes afterwards, so
+ * algorithms read it in place instead of copying it.
+ */
+class csr_graph {
+    struct arc {
+        int v;
+        int weight;
+    };
+
+    int num_vertices;
+    std::vector<long> offsets;
+    std::vector<arc> arcs;
+
+    /* Reads an unsigned decimal number at 'p'; false if there is none. */
+    static bool parse_int(const char*& p, const char* end, int& out) {
+        while(p < end && (*p == ' ' || *p == '\t')) {
+            ++p;
+        }
+        if(p == end || *p < '0' || *p > '9') {
+            return false;
+        }
+        out = 0;
+        while(p < end && *p >= '0' && *p <= '9') {
+            out = out*10 + (*p++ - '0');
+        }
+        return true;
+    }
+
+public:
+    csr_graph() : num_vertices(0), offsets(1, 0), arcs() {}
+
+    /* Graph with 'vertices' vertices, or just enough for the largest
+     * endpoint in 'edges' if that is larger. */
+    csr_graph(int vertices, const std::vector<edge>& edges) :
+        num_vertices(0), offsets(), arcs()
+    {
+        build(vertices, edges);
+    }
+
+    void build(int vertices, const std::vector<edge>& edges) {
+        num_vertices = vertices;
+        for(const edge& e : edges) {
+            num_vertices = e.u >= num_vertices ? e.u + 1 : num_vertices;
+            num_vertices = e.v >= num_vertices ? e.v + 1 : num_vertices;
+        }
+
+        /* offsets[u + 1] counts the arcs of u, then becomes the end of
+         * u's range once summed; 'next' walks each range while filling */
+        offsets.assign(num_vertices + 1, 0);
+        for(const edge& e : edges) {
+            ++offsets[e.u + 1];
+            ++offsets[e.v + 1];
+        }
+        for(int u = 0; u < num_vertices; ++u) {
+            offsets[u + 1] += offsets[u];
+        }
+        std::vector<long> next(offsets.begin(), offsets.end() - 1);
+        arcs.resize(offsets[num_vertices]);
+        for(const edge& e : edges) {
+            arcs[next[e.u]++] = arc{e.v, e.weight};
+            arcs[next[e.v]++] = arc{e.u, e.weight};
+        }
+    }
+
+    /*
+     * Loads an edge list with one "u v weight" line per edge; empty lines
+     * and lines starting with '#' are skipped. The file is mapped into
+     * memory and parsed in place. Returns false, leaving the graph empty,
+     * if it cannot be read or a line is malformed.
+     */
+    bool load(const char* path) {
+        build(0, std::vector<edge>());
+        int fd = open(path, O_RDONLY);
+        if(fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if(fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        std::vector<edge> edges;
+        bool ok = true;
+        if(st.st_size > 0) {
+            void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data == MAP_FAILED) {
+                close(fd);
+                return false;
+            }
+            madvise(data, st.st_size, MADV_SEQUENTIAL);
+            const char* p = (const char*)data;
+            const char* end = p + st.st_size;
+            while(ok && p < end) {
+                if(*p == '#' || *p == '\n' || *p == '\r') {
+                    while(p < end && *p++ != '\n') {
+                    }
+                    continue;
+                }
+                edge e;
+                ok = parse_int(p, end, e.u) && parse_int(p, end, e.v) &&
+                     parse_int(p, end, e.weight);
+                while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+                    ++p;
+                }
+                ok = ok && (p == end || *p++ == '\n');
+                edges.push_back(e);
+            }
+            munmap(data, st.st_size);
+        }
+        close(fd);
+        if(ok) {
+            build(0, edges);
+        }
+        return ok;
+    }
+
+    int vertices() const {
+        return num_vertices;
+    }
+
+    /* Number of undirected edges. */
+    long edges() const {
+        return arcs.size()/2;
+    }
+
+    /*
+     * Eager Prim's, like Graph::prims_algo_eager(), writing the edges of
+     * the minimum spanning forest to 'mst' and returning their total
+     * weight. Visited vertices are a byte array, and the heap is sized
+     * once up front.
+     */
+    long long prims(std::vector<edge>& mst) const {
+        std::vector<unsigned char> in_tree(num_vertices, 0);
+        std::vector<edge> cheapest_edge(num_vertices);
+        indexed_heap<int, Compare<int>, 4> frontier(num_vertices);
+        long long total = 0;
+        mst.clear();
+        mst.reserve(num_vertices);
+
+        for(int root = 0; root < num_vertices; ++root) {
+            if(in_tree[root]) {
+                continue;
+            }
+            frontier.push(root, 0);
+            while(!frontier.empty()) {
+                int u = frontier.pop();
+                in_tree[u] = 1;
+                if(u != root) {
+                    mst.push_back(cheapest_edge[u]);
+                    total += cheapest_edge[u].weight;
+                }
+                for(long i = offsets[u]; i < offsets[u + 1]; ++i) {
+                    const arc& a = arcs[i];
+                    if(in_tree[a.v]) {
+                        continue;
+                    }
+                    if(!frontier.contains(a.v)) {
+                        frontier.push(a.v, a.weight);
+                        cheapest_edge[a.v] = edge(u, a.v, a.weight);
+                    } else if(frontier.decrease_key(a.v, a.weight)) {
+                        cheapest_edge[a.v] = edge(u, a.v, a.weight);
+                    }
+                }
+            }
+        }
+        return total;
+    }
+
+    /* Minimum spanning forest with Borůvka's algorithm on 'num_threads'
+     * threads, returning its weight like prims(). */
+    long long boruvka(std::vector<edge>& mst, int num_threads) const {
+        std::vector<edge> edges;
+        edges.reserve(arcs.size()/2);
+        for(int u = 0; u < num_vertices; ++u) {
+            for(long i = offsets[u]; i < offsets[u + 1]; ++i) {
+                if(u < arcs[i].v) {
+                    edges.push_back(edge(u, arcs[i].v, arcs[i].weight));
+                }
+            }
+        }
+        mst.clear();
+        return parallel_boruvka(num_vertices, edges, mst, num_threads);
+    }
+};
+
+#endif /* _CSR_GRAPH_H_ */
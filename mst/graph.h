@@ -0,0 +1,162 @@
+#ifndef _GRAPH_H_
+#define _GRAPH_H_
+
+#include <iostream>
+#include <vector>
+#include <list>
+
+#include "../heap/my_heap.h"
+#include "../heap/indexed_heap.h"
+#include "boruvka.h"
+
+using namespace std;
+
+struct edge {
+    int u;
+    int v;
+    int weight;
+
+    edge() {}
+
+    edge(const int& _u, const int& _v, const int& _w) : u(_u), v(_v), weight(_w) {}
+};
+
+struct compare_edge {
+    bool operator()(const edge& lhs, const edge& rhs) {
+        return lhs.weight < rhs.weight;
+    }
+};
+
+class Graph {
+    vector<list<edge>> adj_list;
+    vector<edge> mst;
+    int num_edges;
+public: 
+    Graph () : adj_list(), mst(), num_edges(0) {}
+    void print_mst() {
+        if(!mst.empty()) {
+            printf("MST: \n");
+            for(const edge& e : mst) {
+                printf("(%d)---%d---(%d)\n", e.u, e.weight, e.v);
+            }
+        }
+    }
+
+    /* Every vertex joins the tree once, so its edges are pushed straight
+     * from adj_list, without copying the graph first. When the heap runs
+     * out, the rest of the graph is not reachable, and a new tree starts
+     * from the next vertex not visited yet, so a disconnected graph gets a
+     * minimum spanning forest. */
+    void prims_algo() {
+        vector<char> visited(adj_list.size(), 0);
+        my_heap<edge, compare_edge> cheapest_edge;
+        mst = vector<edge>();
+
+        for(size_t root = 0; root < adj_list.size(); ++root) {
+            if(visited[root]) {
+                continue;
+            }
+            int u = root;
+            visited[u] = 1;
+            for(;;) {
+                for(const edge& e : adj_list[u]) {
+                    if(!visited[e.v]) {
+                        cheapest_edge.push(e);
+                    }
+                }
+                while(!cheapest_edge.empty() &&
+                      visited[cheapest_edge.top().v]) {
+                    cheapest_edge.pop();
+                }
+                if(cheapest_edge.empty()) {
+                    break;
+                }
+                edge _e = cheapest_edge.pop();
+                mst.push_back(_e);
+                u = _e.v;
+                visited[u] = 1;
+            }
+        }
+    }
+
+    /* Prim's algorithm keeping one entry per vertex outside the tree,
+     * keyed by the cheapest known edge into it. Each edge costs at most a
+     * decrease_key(), so the heap never holds more than V entries, instead
+     * of one per edge with stale ones skipped as in prims_algo(). Like
+     * prims_algo(), it builds a forest on disconnected graphs. */
+    void prims_algo_eager() {
+        int n = adj_list.size();
+        vector<bool> in_tree(n, false);
+        vector<edge> cheapest_edge(n);
+        indexed_heap<int> frontier(n);
+        mst = vector<edge>();
+
+        for(int root = 0; root < n; ++root) {
+            if(in_tree[root]) {
+                continue;
+            }
+            frontier.push(root, 0);
+            while(!frontier.empty()) {
+                int u = frontier.pop();
+                in_tree[u] = true;
+                if(u != root) {
+                    mst.push_back(cheapest_edge[u]);
+                }
+                for(const edge& e : adj_list[u]) {
+                    if(in_tree[e.v]) {
+                        continue;
+                    }
+                    if(!frontier.contains(e.v)) {
+                        frontier.push(e.v, e.weight);
+                        cheapest_edge[e.v] = e;
+                    } else if(frontier.decrease_key(e.v, e.weight)) {
+                        cheapest_edge[e.v] = e;
+                    }
+                }
+            }
+        }
+    }
+
+    /* Minimum spanning forest with Borůvka's algorithm on 'num_threads'
+     * threads (see boruvka.h). Each undirected edge is handed over once. */
+    void boruvka_algo(int num_threads = 1) {
+        vector<edge> edges;
+        edges.reserve(num_edges);
+        for(const list<edge>& l : adj_list) {
+            for(const edge& e : l) {
+                if(e.u < e.v) {
+                    edges.push_back(e);
+                }
+            }
+        }
+        mst = vector<edge>();
+        parallel_boruvka((int)adj_list.size(), edges, mst, num_threads);
+    }
+
+    long long mst_weight() const {
+        long long total = 0;
+        for(const edge& e : mst) {
+            total += e.weight;
+        }
+        return total;
+    }
+
+    int mst_size() const {
+        return mst.size();
+    }
+
+    void add_edge(const int& u, const int& v, const int& w, const bool& doubly_linked = true) {
+        while(u >= adj_list.size()) {
+            adj_list.push_back(list<edge>());
+        }
+        edge e(u, v, w);
+        adj_list[u].push_back(e);
+        if(doubly_linked) {
+            --num_edges;
+            add_edge(v, u, w, false);
+        }
+        ++num_edges;
+    }
+};
+
+#endif /* _GRAPH_H_ */
@@ -1,83 +1,4 @@
-#include <iostream>
-#include <set>
-#include <vector>
-#include <list>
-
-#include "../heap/my_heap.h"
-
-using namespace std;
-
-struct edge {
-    int u;
-    int v;
-    int weight;
-
-    edge() {}
-
-    edge(const int& _u, const int& _v, const int& _w) : u(_u), v(_v), weight(_w) {}
-};
-
-struct compare_edge {
-    bool operator()(const edge& lhs, const edge& rhs) {
-        return lhs.weight < rhs.weight;
-    }
-};
-
-class Graph {
-    vector<list<edge>> adj_list;
-    vector<edge> mst;
-    int num_edges;
-public: 
-    Graph () : adj_list(), mst(), num_edges(0) {}
-    void print_mst() {
-        if(!mst.empty()) {
-            printf("MST: \n");
-            for(const edge& e : mst) {
-                printf("(%d)---%d---(%d)\n", e.u, e.weight, e.v);
-            }
-        }
-    }
-
-    void prims_algo() {
-        set<int> s;
-        my_heap<edge, compare_edge> cheapest_edge;
-        vector<list<edge>> adj_list_copy(adj_list);
-        mst = vector<edge>();
-
-        int u = 0;
-        s.insert(0);
-        do {
-            while(!adj_list_copy[u].empty()) {
-                edge e = adj_list_copy[u].front();
-                cheapest_edge.push(e);
-                adj_list_copy[u].pop_front();
-            }
-            edge _e = cheapest_edge.top();
-            while(!cheapest_edge.empty() && s.count(_e.v)) {
-                cheapest_edge.pop();
-                _e = cheapest_edge.top();
-            }
-            mst.push_back(_e);
-            u = _e.v;
-            s.insert(u);
-        } while (s.size() != adj_list_copy.size());
-    
-    }
-
-    void add_edge(const int& u, const int& v, const int& w, const bool& doubly_linked = true) {
-        while(u >= adj_list.size()) {
-            adj_list.push_back(list<edge>());
-        }
-        edge e(u, v, w);
-        adj_list[u].push_back(e);
-        if(doubly_linked) {
-            --num_edges;
-            add_edge(v, u, w, false);
-        }
-        ++num_edges;
-    }
-};
-
+#include "graph.h"
 
 int main() {
 
@@ -101,5 +22,34 @@ int main() {
     g.prims_algo();
     g.print_mst();
 
+    g.prims_algo_eager();
+    g.print_mst();
+
+    g.boruvka_algo(2);
+    g.print_mst();
+
+    Graph forest;
+    forest.add_edge(0,1,5);
+    forest.add_edge(2,3,1);
+    forest.add_edge(3,4,2);
+    forest.add_edge(2,4,6);
+
+    /* Disconnected graph:
+        (0)---5---(1)     (2)---1---(3)
+                            \        |
+                             6       2
+                              \      |
+                               ----(4)
+    */
+
+    forest.prims_algo();
+    forest.print_mst();
+
+    forest.prims_algo_eager();
+    forest.print_mst();
+
+    forest.boruvka_algo(2);
+    forest.print_mst();
+
     return 0;
 }
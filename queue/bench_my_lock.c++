@@ -0,0 +1,80 @@
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+#include "my_lock.h"
+
+#define MAX_THREADS 16
+#define OPS_PER_THREAD 10000
+
+/* Benchmark: every thread takes the lock OPS_PER_THREAD times, as a writer
+ * with the given probability and as a reader otherwise. Writers keep two
+ * counters equal, readers check that they are, so a broken lock shows up
+ * as errors. */
+struct shared_data {
+    long a, b;
+    long errors;
+};
+
+template <typename L>
+void run_thread(L* l, shared_data* d, int write_percent, unsigned seed) {
+    for(int i = 0; i < OPS_PER_THREAD; ++i) {
+        if((int)(rand_r(&seed) % 100) < write_percent) {
+            l->w_lock();
+            ++d->a;
+            ++d->b;
+            l->w_unlock();
+        } else {
+            l->r_lock();
+            if(d->a != d->b) {
+                __atomic_fetch_add(&d->errors, 1, __ATOMIC_RELAXED);
+            }
+            l->r_unlock();
+        }
+    }
+}
+
+/* Returns lock acquisitions per second; 'errors' counts broken invariants. */
+template <typename L>
+double bench(L* l, int num_threads, int write_percent, long& errors) {
+    std::vector<std::thread> threads;
+    shared_data d = {0, 0, 0};
+
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < num_threads; ++i) {
+        threads.push_back(std::thread(run_thread<L>, l, &d, write_percent,
+                                      i + 1));
+    }
+    for(std::thread& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    errors += d.errors;
+    return num_threads * double(OPS_PER_THREAD) /
+           std::chrono::duration<double>(end - start).count();
+}
+
+int main() {
+    int write_percents[] = {50, 10, 1};
+    long errors = 0;
+
+    printf("writes threads   reader-pref   writer-pref    phase-fair   distributed\n");
+    for(int write_percent : write_percents) {
+        for(int n = 1; n <= MAX_THREADS; n <<= 1) {
+            my_lock reader_pref(READER_PREFERRING);
+            my_lock writer_pref(WRITER_PREFERRING);
+            my_lock phase_fair(PHASE_FAIR);
+            my_distributed_lock distributed;
+            printf("%5d%% %7d %13.0f %13.0f %13.0f %13.0f\n", write_percent, n,
+                   bench(&reader_pref, n, write_percent, errors),
+                   bench(&writer_pref, n, write_percent, errors),
+                   bench(&phase_fair, n, write_percent, errors),
+                   bench(&distributed, n, write_percent, errors));
+        }
+    }
+    printf("%s (%ld broken invariants)\n",
+           errors ? "Something went wrong..." : "Test passed.", errors);
+
+    return 0;
+}
@@ -0,0 +1,219 @@
+#ifndef _MPMC_QUEUE_H_
+#define _MPMC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+#define MPMC_DEFAULT_CAPACITY 1024
+#define CACHE_LINE_SIZE 64
+
+/*
+ * Bounded lock-free queue for multiple producers and multiple consumers.
+ * Elements live in a ring whose capacity is rounded up to a power of two;
+ * every slot carries a sequence number that tells producers and consumers
+ * whether it is ready for them, so each push or pop takes a single CAS on
+ * the producer or consumer index. The two indices sit on separate cache
+ * lines so producers and consumers do not invalidate each other.
+ *
+ * Mirrors my_queue: push() adds a new element, pop() removes the oldest
+ * one, front() peeks at the newest and back() at the oldest. try_push() and
+ * try_pop() never block; push() and wait_pop() wait for room or data.
+ */
+template <typename T>
+class mpmc_queue {
+    struct cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    cell* cells;
+    size_t mask;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueue_pos;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeue_pos;
+    char pad[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+
+    static size_t round_up(size_t capacity) {
+        size_t result = 2;
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    /*
+     * Copies a trivially copyable T one word (or byte) at a time with
+     * relaxed atomic accesses. A producer may be filling a slot while
+     * peek() reads it; doing both sides this way makes that a torn read,
+     * which peek() detects, rather than a data race.
+     */
+    static void atomic_copy(T* dst, const T* src) {
+        typedef typename std::conditional<
+            sizeof(T) % sizeof(size_t) == 0 && alignof(T) >= alignof(size_t),
+            size_t, unsigned char>::type word;
+        word* d = reinterpret_cast<word*>(dst);
+        const word* s = reinterpret_cast<const word*>(src);
+        for (size_t i = 0; i < sizeof(T) / sizeof(word); ++i) {
+            __atomic_store_n(&d[i], __atomic_load_n(&s[i], __ATOMIC_RELAXED),
+                             __ATOMIC_RELAXED);
+        }
+    }
+
+    /*
+     * Copies the element in the slot for 'pos' if it still holds it after
+     * the copy, as a seqlock reader would; only valid for trivially
+     * copyable types, whose slots are written with atomic_copy().
+     */
+    bool peek(size_t pos, T& out) const {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "front() and back() need a trivially copyable T.");
+        const cell& c = cells[pos & mask];
+        if (c.seq.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        atomic_copy(&out, &c.data);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return c.seq.load(std::memory_order_relaxed) == pos + 1;
+    }
+
+public:
+    mpmc_queue(size_t capacity = MPMC_DEFAULT_CAPACITY) :
+        cells(new cell[round_up(capacity)]),
+        mask(round_up(capacity) - 1),
+        enqueue_pos(0),
+        dequeue_pos(0),
+        pad()
+    {
+        for (size_t i = 0; i <= mask; ++i) {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    bool try_push(const T& value) {
+        cell* c;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &cells[pos & mask];
+            size_t seq = c->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                      std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                /* The slot still holds an element from the previous lap */
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            atomic_copy(&c->data, &value);
+        } else {
+            c->data = value;
+        }
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        cell* c;
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &cells[pos & mask];
+            size_t seq = c->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                                      std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                /* The slot has not been filled yet: the queue is empty */
+                return false;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(c->data);
+        c->seq.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Waits until there is room for the element. */
+    void push(const T& value) {
+        while (!try_push(value)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /* Waits until there is an element to remove. */
+    void wait_pop(T& out) {
+        while (!try_pop(out)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /* Newest element, or T() if the queue is empty. */
+    T front() const {
+        T t;
+        for (;;) {
+            size_t pos = enqueue_pos.load(std::memory_order_acquire);
+            if (pos == dequeue_pos.load(std::memory_order_acquire)) {
+                return T();
+            }
+            if (peek(pos - 1, t)) {
+                return t;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    /* Oldest element, or T() if the queue is empty. */
+    T back() const {
+        T t;
+        for (;;) {
+            size_t pos = dequeue_pos.load(std::memory_order_acquire);
+            if (pos == enqueue_pos.load(std::memory_order_acquire)) {
+                return T();
+            }
+            if (peek(pos, t)) {
+                return t;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    /* Removes the oldest element, if any. */
+    void pop() {
+        T t;
+        try_pop(t);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /* Number of elements; only a snapshot while other threads are active. */
+    int size() const {
+        size_t tail = dequeue_pos.load(std::memory_order_acquire);
+        size_t head = enqueue_pos.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    int capacity() const {
+        return mask + 1;
+    }
+
+    ~mpmc_queue() {
+        delete [] cells;
+    }
+};
+
+#endif /* _MPMC_QUEUE_H_ */
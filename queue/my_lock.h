@@ -2,13 +2,45 @@
 #define _MY_LOCK_H_
 
 #include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <time.h>
+#include <atomic>
+
+#define LOCK_READER_SLOTS 64
+#define LOCK_CACHE_LINE 64
+
+/*
+ * Who goes first when both readers and writers are waiting for a my_lock.
+ *  - READER_PREFERRING: readers get in whenever no writer holds the lock;
+ *    a steady stream of readers can starve writers.
+ *  - WRITER_PREFERRING: a waiting writer holds off new readers; a steady
+ *    stream of writers can starve readers.
+ *  - PHASE_FAIR: read and write phases alternate. Readers arriving while
+ *    a writer waits go in right after that writer, together, and the next
+ *    writer waits for them. Neither side can starve.
+ */
+enum lock_policy {
+    READER_PREFERRING,
+    WRITER_PREFERRING,
+    PHASE_FAIR
+};
 
 struct my_lock {
     pthread_cond_t readers_cv, writers_cv;
     pthread_mutex_t lock;
-    int num_readers, num_writers;
-    my_lock() : readers_cv(), writers_cv(), lock(), 
-                num_readers(0), num_writers(0)
+    lock_policy policy;
+    int num_readers; // Readers holding the lock.
+    bool writing; // Whether a writer holds the lock.
+    int waiting_readers, waiting_writers;
+    /* PHASE_FAIR: completed write phases, and readers let in by the last
+     * one that have not taken the lock yet */
+    unsigned write_phases;
+    int entering_readers;
+    my_lock(lock_policy _policy = WRITER_PREFERRING) :
+                readers_cv(), writers_cv(), lock(), policy(_policy),
+                num_readers(0), writing(false), waiting_readers(0),
+                waiting_writers(0), write_phases(0), entering_readers(0)
     {
         pthread_cond_init(&readers_cv, NULL);
         pthread_cond_init(&writers_cv, NULL);
@@ -17,26 +49,49 @@ struct my_lock {
 
     void w_lock() {
         pthread_mutex_lock(&lock);
-        ++num_writers;
-        if(num_writers > 1 || num_readers > 0) {
+        ++waiting_writers;
+        while(writing || num_readers > 0 || entering_readers > 0 ||
+              (policy == READER_PREFERRING && waiting_readers > 0)) {
             pthread_cond_wait(&writers_cv, &lock);
         }
+        --waiting_writers;
+        writing = true;
         pthread_mutex_unlock(&lock);
     }
     void w_unlock() {
         pthread_mutex_lock(&lock);
-        --num_writers;
-        if(num_writers > 0) {
+        writing = false;
+        ++write_phases;
+        if(policy == PHASE_FAIR) {
+            entering_readers = waiting_readers;
+        }
+        if(waiting_readers > 0 &&
+           (policy != WRITER_PREFERRING || waiting_writers == 0)) {
+            pthread_cond_broadcast(&readers_cv);
+        } else if(waiting_writers > 0) {
             pthread_cond_signal(&writers_cv);
         }
-        pthread_cond_broadcast(&readers_cv);
         pthread_mutex_unlock(&lock);
     }
 
     void r_lock() {
         pthread_mutex_lock(&lock);
-        while(num_writers > 0) {
-            pthread_cond_wait(&readers_cv, &lock);
+        if(writing || (policy != READER_PREFERRING && waiting_writers > 0)) {
+            unsigned phase = write_phases;
+            ++waiting_readers;
+            if(policy == PHASE_FAIR) {
+                /* Wait for the end of the next write phase */
+                while(writing || write_phases == phase) {
+                    pthread_cond_wait(&readers_cv, &lock);
+                }
+                --entering_readers;
+            } else {
+                while(writing || (policy == WRITER_PREFERRING &&
+                                  waiting_writers > 0)) {
+                    pthread_cond_wait(&readers_cv, &lock);
+                }
+            }
+            --waiting_readers;
         }
         ++num_readers;
         pthread_mutex_unlock(&lock);
@@ -44,7 +99,7 @@ struct my_lock {
     void r_unlock() {
         pthread_mutex_lock(&lock);
         --num_readers;
-        if(num_readers == 0 && num_writers > 0) {
+        if(num_readers == 0 && entering_readers == 0 && waiting_writers > 0) {
             pthread_cond_signal(&writers_cv);
         }
         pthread_mutex_unlock(&lock);
@@ -56,4 +111,136 @@ struct my_lock {
     }
 };
 
+/*
+ * Reader/writer lock with the same interface as my_lock, for read-mostly
+ * workloads. Readers only touch a counter of their own, on its own cache
+ * line, so they do not contend with each other. Each thread is given one
+ * of LOCK_READER_SLOTS counters, round robin. Writers are serialized by a
+ * mutex, raise a flag that holds off new readers, and wait for every
+ * counter to drain, so taking the write lock is O(LOCK_READER_SLOTS).
+ * Waiting is done by yielding the CPU. Writers are preferred.
+ */
+struct my_distributed_lock {
+    struct alignas(LOCK_CACHE_LINE) reader_slot {
+        std::atomic<int> count;
+    };
+    reader_slot slots[LOCK_READER_SLOTS];
+    alignas(LOCK_CACHE_LINE) std::atomic<bool> writing;
+    pthread_mutex_t writers_lock;
+    my_distributed_lock() : slots(), writing(false), writers_lock()
+    {
+        pthread_mutex_init(&writers_lock, NULL);
+    }
+
+    static int slot() {
+        static std::atomic<unsigned> next_slot(0);
+        static thread_local int s = next_slot.fetch_add(1) % LOCK_READER_SLOTS;
+        return s;
+    }
+
+    void w_lock() {
+        pthread_mutex_lock(&writers_lock);
+        writing.store(true);
+        for(int i = 0; i < LOCK_READER_SLOTS; ++i) {
+            while(slots[i].count.load() != 0) {
+                sched_yield();
+            }
+        }
+    }
+    void w_unlock() {
+        writing.store(false);
+        pthread_mutex_unlock(&writers_lock);
+    }
+
+    void r_lock() {
+        std::atomic<int>& count = slots[slot()].count;
+        for(;;) {
+            count.fetch_add(1);
+            if(!writing.load()) {
+                return;
+            }
+            count.fetch_sub(1);
+            while(writing.load()) {
+                sched_yield();
+            }
+        }
+    }
+    void r_unlock() {
+        slots[slot()].count.fetch_sub(1, std::memory_order_release);
+    }
+    ~my_distributed_lock() {
+        pthread_mutex_destroy(&writers_lock);
+    }
+};
+
+/*
+ * Lets threads sleep until a predicate becomes true. Threads that change
+ * the state the predicate looks at call notify_one() or notify_all()
+ * afterwards; that is a single atomic load when nobody is waiting.
+ */
+struct my_signal {
+    pthread_cond_t cv;
+    pthread_mutex_t lock;
+    std::atomic<int> waiters;
+    my_signal() : cv(), lock(), waiters(0)
+    {
+        /* Deadlines are on the monotonic clock, so that setting the
+         * system time neither cuts a timed wait short nor stretches it */
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&cv, &attr);
+        pthread_condattr_destroy(&attr);
+        pthread_mutex_init(&lock, NULL);
+    }
+
+    /* Waits until ready() returns true or, if 'deadline' is given, until
+     * that CLOCK_MONOTONIC time passes. Returns the last result of ready(). */
+    template <typename Pred>
+    bool wait(Pred ready, const struct timespec* deadline = NULL) {
+        bool result;
+        pthread_mutex_lock(&lock);
+        /* Registering before checking ready() pairs with the fence in
+         * notify_*(), so a notification cannot slip in between the two. */
+        waiters.fetch_add(1);
+        while(!(result = ready())) {
+            if(!deadline) {
+                pthread_cond_wait(&cv, &lock);
+            } else {
+                /* Anything but a wakeup ends the wait: ETIMEDOUT, and also
+                 * EINVAL for a malformed deadline rather than spinning */
+                int error = pthread_cond_timedwait(&cv, &lock, deadline);
+                if(error != 0 && error != EINTR) {
+                    result = ready();
+                    break;
+                }
+            }
+        }
+        waiters.fetch_sub(1);
+        pthread_mutex_unlock(&lock);
+        return result;
+    }
+
+    void notify_one() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(waiters.load() > 0) {
+            pthread_mutex_lock(&lock);
+            pthread_cond_signal(&cv);
+            pthread_mutex_unlock(&lock);
+        }
+    }
+    void notify_all() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(waiters.load() > 0) {
+            pthread_mutex_lock(&lock);
+            pthread_cond_broadcast(&cv);
+            pthread_mutex_unlock(&lock);
+        }
+    }
+    ~my_signal() {
+        pthread_cond_destroy(&cv);
+        pthread_mutex_destroy(&lock);
+    }
+};
+
 #endif /* _MY_LOCK_H_ */
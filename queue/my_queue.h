@@ -1,51 +1,151 @@
+#include <atomic>
+#include <chrono>
 #include <deque>
+#include <utility>
 #include "my_lock.h"
 
 /* 
  * Thread-safe queue backed by a deque. Uses monitors to achive synchro-
  * nization; allows multiple readers and a single writer at a time. 
+ * Elements are pushed at the front and popped from the back. The *_bulk()
+ * functions move many elements under a single critical section.
+ * Consumers can sleep until data arrives with wait_pop(); close() wakes
+ * them all up once the queue has been drained.
  */
 
 template <typename T, class C = std::deque<T>>
 class my_queue {
     C q;
     my_lock l;
+    my_signal data_ready;
+    std::atomic<bool> closed;
 public:
-    my_queue() : q(), l()
+    my_queue() : q(), l(), data_ready(), closed(false)
     { }
 
     void push(const T& value) {
         l.w_lock();
         q.push_front(value);
         l.w_unlock();
+        data_ready.notify_one();
+    }
+
+    void push(T&& value) {
+        l.w_lock();
+        q.push_front(std::move(value));
+        l.w_unlock();
+        data_ready.notify_one();
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        l.w_lock();
+        q.emplace_front(std::forward<Args>(args)...);
+        l.w_unlock();
+        data_ready.notify_one();
+    }
+
+    /* Pushes every element of [first, last), in order. */
+    template <typename InputIt>
+    void push_bulk(InputIt first, InputIt last) {
+        l.w_lock();
+        for(; first != last; ++first) {
+            q.push_front(*first);
+        }
+        l.w_unlock();
+        data_ready.notify_all();
     }
 
     T front ()  {
-        T t;
+        T t = T();
+        l.r_lock();
         if(!q.empty()) {
-            l.r_lock();
             t = q.front();
-            l.r_unlock();
         }
+        l.r_unlock();
         return t;
     }
 
     T back ()  {
-        T t;
+        T t = T();
+        l.r_lock();
         if(!q.empty()) {
-            l.r_lock();
             t = q.back();
-            l.r_unlock();
         }
+        l.r_unlock();
         return t;
     }
 
     void pop() {
+        l.w_lock();
+        if(!q.empty()) {
+            q.pop_back();
+        }
+        l.w_unlock();
+    }
+
+    /* Atomically removes the oldest element into 'out'; false if empty. */
+    bool try_pop(T& out) {
+        bool popped = false;
+        l.w_lock();
         if(!q.empty()) {
-            l.w_lock();
+            out = std::move(q.back());
+            q.pop_back();
+            popped = true;
+        }
+        l.w_unlock();
+        return popped;
+    }
+
+    /* Sleeps until an element can be removed into 'out'. Returns false,
+     * without waiting, once the queue is closed and empty. */
+    bool wait_pop(T& out) {
+        bool popped = false;
+        data_ready.wait([&] { return (popped = try_pop(out)) || closed; });
+        return popped;
+    }
+
+    /* Same as wait_pop(), but also gives up after 'timeout'. */
+    template <typename Rep, typename Period>
+    bool wait_pop_for(T& out, const std::chrono::duration<Rep, Period>& timeout) {
+        bool popped = false;
+        struct timespec deadline;
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            timeout).count();
+        ns = ns < 0 ? 0 : ns;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        ns += deadline.tv_nsec;
+        deadline.tv_sec += ns / 1000000000;
+        deadline.tv_nsec = ns % 1000000000;
+        data_ready.wait([&] { return (popped = try_pop(out)) || closed; },
+                        &deadline);
+        return popped;
+    }
+
+    /* Wakes up every waiting consumer; wait_pop() stops blocking once the
+     * remaining elements have been consumed. Pushing is still allowed. */
+    void close() {
+        closed = true;
+        data_ready.notify_all();
+    }
+
+    bool is_closed() const {
+        return closed;
+    }
+
+    /* Moves up to 'max' of the oldest elements, oldest first, to 'out'.
+     * Returns how many were moved. */
+    template <typename OutputIt>
+    int pop_bulk(OutputIt out, int max) {
+        int n = 0;
+        l.w_lock();
+        for(; n < max && !q.empty(); ++n) {
+            *out = std::move(q.back());
+            ++out;
             q.pop_back();
-            l.w_unlock();
         }
+        l.w_unlock();
+        return n;
     }
 
     bool empty() const {
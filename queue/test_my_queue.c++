@@ -1,18 +1,31 @@
+#include <chrono>
 #include <iostream>
+#include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
 #include "my_queue.h"
+#include "mpmc_queue.h"
 
 #define NUM_THREADS 30
 #define NUMS_PER_THREAD 100
+#define BENCH_OPS_PER_THREAD 20000
+#define BATCH_THREADS 8
+#define IDLE_CONSUMERS 4
+#define IDLE_MS 200
+#define WAKEUPS 200
+#define WAKEUP_GAP_US 200
 
 /* Test: consists of pushing NUMS_PER_THREADS numbers into
  * the queue and then pop all of them except the last one.
  * We make dummy calls to front() and back() just to invoke
  * many readings to the queue and test its responsiveness
  * to many threads). */
+template <typename Q>
 void *run_test(void* _q) {
-    my_queue<int>* q = ((my_queue<int>*)_q);
-    
+    Q* q = ((Q*)_q);
+
     int counter = std::rand() % 100 + 1;
     for(int i = 0; i < NUMS_PER_THREAD; ++i, ++counter) {
         q->push(counter);
@@ -25,25 +38,260 @@ void *run_test(void* _q) {
         }
         q->back();
     }
+    return NULL;
 }
 
-int main() {
-
+template <typename Q>
+void test(Q& q, const char* name) {
     pthread_t threads[NUM_THREADS];
-    my_queue<int> q;
-    int rc;
     void* status;
 
     for(int i = 0; i < NUM_THREADS; ++i) {
-        rc = pthread_create(&threads[i], NULL, run_test, (void *)&q);
+        pthread_create(&threads[i], NULL, run_test<Q>, (void *)&q);
     }
 
     for(int i = 0; i < NUM_THREADS; ++i) {
-        rc = pthread_join(threads[i], &status);
+        pthread_join(threads[i], &status);
     }
 
-    std::cout << "Queue size: " << q.size() << " ... ";
+    std::cout << name << " size: " << q.size() << " ... ";
     std::cout << "front: " << q.front() << " , back: " << q.back() << "\n";
+}
+
+bool take(my_queue<int>& q, int& out) {
+    return q.try_pop(out);
+}
+
+bool take(mpmc_queue<int>& q, int& out) {
+    return q.try_pop(out);
+}
+
+/* Benchmark: every thread pushes an element and takes one back out,
+ * BENCH_OPS_PER_THREAD times. */
+template <typename Q>
+void *run_bench(void* _q) {
+    Q* q = ((Q*)_q);
+    int value;
+    for(int i = 0; i < BENCH_OPS_PER_THREAD; ++i) {
+        q->push(i);
+        take(*q, value);
+    }
+    return NULL;
+}
+
+template <typename Q>
+double bench(int num_threads) {
+    pthread_t threads[NUM_THREADS];
+    void* status;
+    Q q;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < num_threads; ++i) {
+        pthread_create(&threads[i], NULL, run_bench<Q>, (void *)&q);
+    }
+    for(int i = 0; i < num_threads; ++i) {
+        pthread_join(threads[i], &status);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+void report(int num_threads, double locked_secs, double lock_free_secs) {
+    double ops = 2.0 * num_threads * BENCH_OPS_PER_THREAD;
+    printf("%7d %14.0f %14.0f %10.1f %10.1f\n", num_threads,
+           ops / locked_secs, ops / lock_free_secs,
+           1e9 * locked_secs * num_threads / ops,
+           1e9 * lock_free_secs * num_threads / ops);
+}
+
+/* Batch benchmark: like run_bench(), but elements are pushed and popped
+ * 'batch' at a time with push_bulk() and pop_bulk(). */
+struct batch_args {
+    my_queue<int>* q;
+    int batch;
+};
+
+void *run_batch_bench(void* _args) {
+    batch_args* args = (batch_args*)_args;
+    std::vector<int> in(args->batch), out(args->batch);
+    for(int i = 0; i < BENCH_OPS_PER_THREAD; i += args->batch) {
+        args->q->push_bulk(in.begin(), in.end());
+        args->q->pop_bulk(out.begin(), args->batch);
+    }
+    return NULL;
+}
+
+double bench_batch(int batch) {
+    pthread_t threads[BATCH_THREADS];
+    void* status;
+    my_queue<int> q;
+    batch_args args = {&q, batch};
+
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < BATCH_THREADS; ++i) {
+        pthread_create(&threads[i], NULL, run_batch_bench, (void *)&args);
+    }
+    for(int i = 0; i < BATCH_THREADS; ++i) {
+        pthread_join(threads[i], &status);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return 2.0 * BATCH_THREADS * BENCH_OPS_PER_THREAD /
+           std::chrono::duration<double>(end - start).count();
+}
+
+/* Idle benchmark: consumers either sleep in wait_pop() or spin on
+ * try_pop() while nothing is pushed, until the queue is closed. */
+bool spin_consumers;
+
+void *run_idle_consumer(void* _q) {
+    my_queue<int>* q = (my_queue<int>*)_q;
+    int value;
+    if(spin_consumers) {
+        while(!q->is_closed()) {
+            q->try_pop(value);
+        }
+    } else {
+        while(q->wait_pop(value)) {
+        }
+    }
+    return NULL;
+}
+
+double cpu_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Returns the CPU time used while idle, as a percentage of one core. */
+double bench_idle(bool spin) {
+    pthread_t threads[IDLE_CONSUMERS];
+    void* status;
+    my_queue<int> q;
+    spin_consumers = spin;
+
+    for(int i = 0; i < IDLE_CONSUMERS; ++i) {
+        pthread_create(&threads[i], NULL, run_idle_consumer, (void *)&q);
+    }
+    double start = cpu_seconds();
+    usleep(IDLE_MS * 1000);
+    double used = cpu_seconds() - start;
+    q.close();
+    for(int i = 0; i < IDLE_CONSUMERS; ++i) {
+        pthread_join(threads[i], &status);
+    }
+    return 100.0 * used / (IDLE_MS / 1000.0);
+}
+
+/* Wake-up benchmark: a consumer sleeps in wait_pop() until a timestamp is
+ * pushed, and records how long it took to receive it. Optionally, other
+ * threads keep the CPUs busy on another queue in the meantime. */
+long long now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct wakeup_stats {
+    long long total_ns, max_ns;
+    int count;
+};
+
+void *run_wakeup_consumer(void* _q) {
+    my_queue<long long>* q = (my_queue<long long>*)_q;
+    wakeup_stats* st = new wakeup_stats();
+    long long sent;
+    while(q->wait_pop(sent)) {
+        long long latency = now_ns() - sent;
+        st->total_ns += latency;
+        st->max_ns = latency > st->max_ns ? latency : st->max_ns;
+        ++st->count;
+    }
+    return st;
+}
+
+void *run_load(void* _q) {
+    my_queue<int>* q = (my_queue<int>*)_q;
+    int value;
+    while(!q->is_closed()) {
+        q->push(0);
+        q->try_pop(value);
+    }
+    return NULL;
+}
+
+void bench_wakeup(int load_threads) {
+    pthread_t consumer, load[BATCH_THREADS];
+    void* status;
+    my_queue<long long> q;
+    my_queue<int> busy;
+
+    for(int i = 0; i < load_threads; ++i) {
+        pthread_create(&load[i], NULL, run_load, (void *)&busy);
+    }
+    pthread_create(&consumer, NULL, run_wakeup_consumer, (void *)&q);
+    for(int i = 0; i < WAKEUPS; ++i) {
+        usleep(WAKEUP_GAP_US);
+        q.push(now_ns());
+    }
+    q.close();
+    pthread_join(consumer, &status);
+    busy.close();
+    for(int i = 0; i < load_threads; ++i) {
+        pthread_join(load[i], NULL);
+    }
+
+    wakeup_stats* st = (wakeup_stats*)status;
+    printf("%11d %14.1f %14.1f\n", load_threads,
+           st->count ? st->total_ns / 1000.0 / st->count : 0.0,
+           st->max_ns / 1000.0);
+    delete st;
+}
+
+/* Timed waits on an empty queue must give up after 'timeout', and right
+ * away when it is zero or negative. */
+void test_timeout(long long ms) {
+    my_queue<int> q;
+    int value;
+    auto start = std::chrono::steady_clock::now();
+    bool popped = q.wait_pop_for(value, std::chrono::milliseconds(ms));
+    double waited = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "wait_pop_for(" << ms << " ms) on an empty queue: "
+              << (popped ? "popped" : "timed out") << " after "
+              << (long)waited << " ms\n";
+}
+
+int main() {
+
+    my_queue<int> q;
+    mpmc_queue<int> mq(NUM_THREADS * NUMS_PER_THREAD);
+    test(q, "Queue");
+    test(mq, "MPMC queue");
+    test_timeout(-2000);
+    test_timeout(0);
+    test_timeout(1500);
+
+    int thread_counts[] = {1, 2, 4, 8, 16, NUM_THREADS};
+    printf("\nthreads   locked ops/s lockfree ops/s locked ns lockfree ns\n");
+    for(int n : thread_counts) {
+        report(n, bench<my_queue<int>>(n), bench<mpmc_queue<int>>(n));
+    }
+
+    int batch_sizes[] = {1, 4, 16, 64, 256};
+    double single = 0;
+    printf("\nbatch   locked ops/s (%d threads)  speedup\n", BATCH_THREADS);
+    for(int batch : batch_sizes) {
+        double ops = bench_batch(batch);
+        single = batch == 1 ? ops : single;
+        printf("%5d %14.0f %20.1fx\n", batch, ops, ops / single);
+    }
+
+    printf("\nidle CPU with %d consumers: %.1f%% spinning, %.1f%% waiting\n",
+           IDLE_CONSUMERS, bench_idle(true), bench_idle(false));
+
+    printf("\nload threads  avg wake (us)  max wake (us)\n");
+    bench_wakeup(0);
+    bench_wakeup(BATCH_THREADS);
 
     return 0;
 }
@@ -0,0 +1,75 @@
+#include <stdio.h> /* printf */
+#include <chrono> /* steady_clock */
+#include <string> /* string */
+#include <vector> /* vector */
+
+#include "my_vector.h"
+
+#define PUSHES 10000000
+#define HEAVY_PUSHES 1000000
+#define ROUNDS 10
+
+template<typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/* Element that owns heap memory, so growth has to move it rather than
+ * copy its bytes. */
+struct heavy {
+    std::string name;
+    long id;
+
+    explicit heavy(long _id) : name(24, 'a' + _id % 26), id(_id) {}
+};
+
+long value(int x) {
+    return x;
+}
+
+long value(const heavy& x) {
+    return x.id + x.name.size();
+}
+
+/* Time to push 'n' elements one by one, then to read them ROUNDS times. */
+template<typename V, typename T>
+void run(long n, double& push, double& iterate, long& sum) {
+    V v;
+    push = seconds([&] {
+        for(long i = 0; i < n; ++i) {
+            v.emplace_back(T(i));
+        }
+    });
+    sum = 0;
+    iterate = seconds([&] {
+        for(int round = 0; round < ROUNDS; ++round) {
+            for(const T& x : v) {
+                sum += value(x);
+            }
+        }
+    });
+}
+
+template<typename T>
+void compare(const char* name, long n) {
+    double push[2], iterate[2];
+    long sums[2];
+    run<std::vector<T>, T>(n, push[0], iterate[0], sums[0]);
+    run<my_vector<T>, T>(n, push[1], iterate[1], sums[1]);
+    printf("%-6s %9ld %10.1f %10.1f %10.1f %10.1f%s\n", name, n,
+           n / push[0] / 1e6, n / push[1] / 1e6,
+           n * ROUNDS / iterate[0] / 1e6, n * ROUNDS / iterate[1] / 1e6,
+           sums[0] == sums[1] ? "" : "  (results differ!)");
+}
+
+int main() {
+    printf("                    push M/s              iterate M/s\n");
+    printf("type     elements std::vector  my_vector std::vector  my_vector\n");
+    compare<int>("int", PUSHES);
+    compare<heavy>("heavy", HEAVY_PUSHES);
+
+    return 0;
+}
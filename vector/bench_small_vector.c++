@@ -0,0 +1,152 @@
+/*
+ * Benchmark for my_vector's inline storage and allocator parameter. Builds
+ * lots of vectors of 0 to MAX_ELEMENTS - 1 ints, most of them small, with
+ * memory from the global heap or from an allocator<N> arena, and counts
+ * the allocations each variant needs.
+ *
+ * Build with -DNDEBUG so that no integrity checks are done.
+ */
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <chrono> /* steady_clock */
+#include <functional> /* function */
+#include <vector> /* vector */
+
+#include "my_vector.h"
+#include "../allocator/allocator.h"
+
+#define VECTORS 1000000
+#define RETAINED 200000
+#define MAX_ELEMENTS 12
+#define INLINE 8
+#define ARENA_SIZE (64 << 20)
+
+typedef allocator<ARENA_SIZE, SEGREGATED_FIT> arena_t;
+
+static long heap_allocations = 0;
+
+/* std::allocator that counts its allocations. */
+template<typename T>
+struct counting_allocator {
+    typedef T value_type;
+
+    counting_allocator() {}
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) {}
+
+    T* allocate(size_t n) {
+        ++heap_allocations;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* ptr, size_t n) {
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template<typename U>
+    bool operator==(const counting_allocator<U>&) const {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(const counting_allocator<U>&) const {
+        return false;
+    }
+};
+
+template<typename T>
+using arena_alloc = arena_allocator<T, ARENA_SIZE, SEGREGATED_FIT>;
+
+template<typename F>
+double seconds(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/* One short-lived vector per iteration, as in a hot loop. */
+template<typename V, typename Alloc>
+long temporaries(const std::vector<int>& sizes, const Alloc& alloc) {
+    long sum = 0;
+    for(int size : sizes) {
+        V v(alloc);
+        for(int i = 0; i < size; ++i) {
+            v.push_back(i);
+        }
+        for(int x : v) {
+            sum += x;
+        }
+    }
+    return sum;
+}
+
+/* RETAINED vectors alive at once, as in adjacency lists. */
+template<typename V, typename Alloc>
+long retained(const std::vector<int>& sizes, const Alloc& alloc) {
+    std::vector<V> lists;
+    lists.reserve(RETAINED);
+    for(int j = 0; j < RETAINED; ++j) {
+        lists.emplace_back(alloc);
+        for(int i = 0; i < sizes[j]; ++i) {
+            lists.back().push_back(i);
+        }
+    }
+    long sum = 0;
+    for(const V& v : lists) {
+        for(int x : v) {
+            sum += x;
+        }
+    }
+    return sum;
+}
+
+template<typename V, typename Alloc>
+void run(const char* name, const std::vector<int>& sizes, const Alloc& alloc,
+         const std::function<long()>& allocations) {
+    long sums[2], counts[2];
+    double secs[2];
+    long before = allocations();
+    secs[0] = seconds([&] {
+        sums[0] = temporaries<V>(sizes, alloc);
+    });
+    counts[0] = allocations() - before;
+    before = allocations();
+    secs[1] = seconds([&] {
+        sums[1] = retained<V>(sizes, alloc);
+    });
+    counts[1] = allocations() - before;
+    printf("%-26s %10.1f %10ld %10.1f %10ld  %ld\n", name,
+           VECTORS / secs[0] / 1e6, counts[0], RETAINED / secs[1] / 1e6,
+           counts[1], sums[0] + sums[1]);
+}
+
+int main() {
+    std::vector<int> sizes(VECTORS);
+    for(int& size : sizes) {
+        size = std::rand() % MAX_ELEMENTS;
+    }
+    std::function<long()> heap_count = [] { return heap_allocations; };
+    arena_t* arena = new arena_t();
+    std::function<long()> arena_count = [&] {
+        return (long)arena->stats().allocations;
+    };
+    counting_allocator<int> heap;
+    arena_alloc<int> in_arena(*arena);
+
+    printf("%d vectors of 0 to %d ints, %d of them retained\n", VECTORS,
+           MAX_ELEMENTS - 1, RETAINED);
+    printf("%-26s %10s %10s %10s %10s  checksum\n", "", "temp M/s",
+           "allocs", "kept M/s", "allocs");
+    run<std::vector<int, counting_allocator<int> > >(
+        "std::vector", sizes, heap, heap_count);
+    run<my_vector<int, 0, counting_allocator<int> > >(
+        "my_vector", sizes, heap, heap_count);
+    run<my_vector<int, INLINE, counting_allocator<int> > >(
+        "my_vector<8>", sizes, heap, heap_count);
+    run<my_vector<int, 0, arena_alloc<int> > >(
+        "my_vector, arena", sizes, in_arena, arena_count);
+    run<my_vector<int, INLINE, arena_alloc<int> > >(
+        "my_vector<8>, arena", sizes, in_arena, arena_count);
+
+    delete arena;
+    return 0;
+}
@@ -5,31 +5,100 @@
 #include <cstdint>
 #include <string.h>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 #define VECTOR_DEFAULT_SIZE 10
 
+/* Room for K elements inside the vector itself, left uninitialized. */
+template<typename T, unsigned K>
+struct inline_storage {
+    alignas(T) unsigned char bytes[K * sizeof(T)];
+
+    inline_storage() {}
+    T* data() { return reinterpret_cast<T*>(bytes); }
+    const T* data() const { return reinterpret_cast<const T*>(bytes); }
+};
+
 template<typename T>
+struct inline_storage<T, 0> {
+    T* data() { return nullptr; }
+    const T* data() const { return nullptr; }
+};
+
+/*
+ * Growable array. Storage is allocated uninitialized and elements are
+ * constructed in place only when they are added, so capacity costs no
+ * constructor calls. Growing relocates the elements with memcpy when T is
+ * trivially copyable, and otherwise moves them (or copies them, if the
+ * move constructor may throw) and destroys the originals.
+ *
+ * The first K elements live inside the vector, so a vector that never
+ * holds more than K elements never allocates; with K = 0 nothing is
+ * allocated before the first element is added. Storage beyond that comes
+ * from A, e.g. an arena_allocator from allocator/allocator.h:
+ *
+ *     allocator<1 << 20> arena;
+ *     arena_allocator<int, 1 << 20> alloc(arena);
+ *     my_vector<int, 8, arena_allocator<int, 1 << 20> > v(alloc);
+ *
+ * An allocator never changes after construction: assigning from a vector
+ * with a different allocator moves or copies the elements over.
+ */
+template<typename T, unsigned K = 0, typename A = std::allocator<T> >
 class my_vector {
 public:
     my_vector();
-    my_vector(const my_vector<T>& rhs);
+    explicit my_vector(const A& alloc);
+    my_vector(const my_vector<T, K, A>& rhs);
+    my_vector(my_vector<T, K, A>&& rhs)
+        noexcept(std::is_nothrow_move_constructible<T>::value);
+    my_vector<T, K, A>& operator=(const my_vector<T, K, A>& rhs);
+    my_vector<T, K, A>& operator=(my_vector<T, K, A>&& rhs);
     ~my_vector();
 
     T* begin();
     T* end();
-    T front() const;
-    T back() const;
-    T operator[](int) const;
-    T at(int) const;
+    const T* begin() const;
+    const T* end() const;
+    T& front();
+    const T& front() const;
+    T& back();
+    const T& back() const;
+    T& operator[](int);
+    const T& operator[](int) const;
+    T& at(int);
+    const T& at(int) const;
     void push_back(const T& value);
+    void push_back(T&& value);
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
     void pop_back();
     void clear();
+    void reserve(unsigned capacity);
+    void resize(unsigned size);
+    void resize(unsigned size, const T& value);
     unsigned size() const;
+    unsigned capacity() const;
     bool empty() const;
+    bool is_inline() const;
+    A get_allocator() const;
     void print() const;
 private:
-    void increase_capacity(); 
+    typedef std::allocator_traits<A> traits;
+
+    void reallocate(unsigned new_capacity);
+    void adopt(T* new_array, unsigned new_capacity);
+    void release();
+    T* allocate(unsigned capacity);
+    void deallocate(T* array, unsigned capacity);
+    static void relocate(T* from, unsigned n, T* to);
 private:
+    inline_storage<T, K> _inline;
+    A _alloc;
     unsigned _capacity;
     unsigned _size;
     T* _array;
@@ -42,21 +111,113 @@ private:
  ****** Constructor & Destructor ******
  **************************************
  */
-template<typename T>
-my_vector<T>::my_vector() :
-    _capacity(VECTOR_DEFAULT_SIZE),
+template<typename T, unsigned K, typename A>
+my_vector<T, K, A>::my_vector() :
+    _alloc(),
+    _capacity(K),
     _size(0),
-    _array(new T[_capacity]),
+    _array(_inline.data()),
     _begin(_array),
     _end(_array)
 {
 
 }
 
-template<typename T>
-my_vector<T>::~my_vector()
+template<typename T, unsigned K, typename A>
+my_vector<T, K, A>::my_vector(const A& alloc) :
+    _alloc(alloc),
+    _capacity(K),
+    _size(0),
+    _array(_inline.data()),
+    _begin(_array),
+    _end(_array)
+{
+
+}
+
+template<typename T, unsigned K, typename A>
+my_vector<T, K, A>::my_vector(const my_vector<T, K, A>& rhs) :
+    _alloc(traits::select_on_container_copy_construction(rhs._alloc)),
+    _capacity(K),
+    _size(0),
+    _array(_inline.data()),
+    _begin(_array),
+    _end(_array)
+{
+    reserve(rhs._size);
+    for (const T& item : rhs) {
+        push_back(item);
+    }
+}
+
+/* Heap storage changes hands; inline elements have to move one by one. */
+template<typename T, unsigned K, typename A>
+my_vector<T, K, A>::my_vector(my_vector<T, K, A>&& rhs)
+    noexcept(std::is_nothrow_move_constructible<T>::value) :
+    _alloc(rhs._alloc),
+    _capacity(K),
+    _size(0),
+    _array(_inline.data()),
+    _begin(_array),
+    _end(_array)
+{
+    if (!rhs.is_inline()) {
+        adopt(rhs._array, rhs._capacity);
+        rhs._array = rhs._begin = rhs._end = rhs._inline.data();
+        rhs._capacity = K;
+    } else {
+        relocate(rhs._array, rhs._size, _array);
+    }
+    _size = rhs._size;
+    _end = _array + _size;
+    rhs._size = 0;
+    rhs._end = rhs._array;
+}
+
+template<typename T, unsigned K, typename A>
+my_vector<T, K, A>&
+my_vector<T, K, A>::operator=(const my_vector<T, K, A>& rhs)
+{
+    if (this != &rhs) {
+        clear();
+        reserve(rhs._size);
+        for (const T& item : rhs) {
+            push_back(item);
+        }
+    }
+    return *this;
+}
+
+/* Takes rhs's heap storage when both allocators can free it, and
+ * otherwise moves the elements into this vector's own storage. */
+template<typename T, unsigned K, typename A>
+my_vector<T, K, A>&
+my_vector<T, K, A>::operator=(my_vector<T, K, A>&& rhs)
+{
+    if (this == &rhs) {
+        return *this;
+    }
+    clear();
+    if (!rhs.is_inline() && _alloc == rhs._alloc) {
+        adopt(rhs._array, rhs._capacity);
+        rhs._array = rhs._begin = rhs._end = rhs._inline.data();
+        rhs._capacity = K;
+    } else {
+        reserve(rhs._size);
+        relocate(rhs._array, rhs._size, _array);
+    }
+    _size = rhs._size;
+    _end = _array + _size;
+    rhs._size = 0;
+    rhs._end = rhs._array;
+    return *this;
+}
+
+template<typename T, unsigned K, typename A>
+my_vector<T, K, A>::~my_vector()
 {
-    delete [] _array;
+    clear();
+    release();
 }
 
 /*
@@ -64,82 +225,204 @@ my_vector<T>::~my_vector()
  **** Public functions ****
  **************************
  */
-template<typename T>
+template<typename T, unsigned K, typename A>
 T*
-my_vector<T>::begin()
+my_vector<T, K, A>::begin()
 {
     return _begin;
 }
 
-template<typename T>
+template<typename T, unsigned K, typename A>
 T*
-my_vector<T>::end()
+my_vector<T, K, A>::end()
 {
     return _end;
 }
 
-template<typename T>
-T
-my_vector<T>::front() const
+template<typename T, unsigned K, typename A>
+const T*
+my_vector<T, K, A>::begin() const
 {
-    return _array[0]; 
+    return _begin;
 }
 
-template<typename T>
-T
-my_vector<T>::back() const
+template<typename T, unsigned K, typename A>
+const T*
+my_vector<T, K, A>::end() const
+{
+    return _end;
+}
+
+template<typename T, unsigned K, typename A>
+T&
+my_vector<T, K, A>::front()
+{
+    return _array[0];
+}
+
+template<typename T, unsigned K, typename A>
+const T&
+my_vector<T, K, A>::front() const
+{
+    return _array[0];
+}
+
+template<typename T, unsigned K, typename A>
+T&
+my_vector<T, K, A>::back()
 {
     return _array[_size - 1];
 }
 
-template<typename T>
-T
-my_vector<T>::at(int i) const
+template<typename T, unsigned K, typename A>
+const T&
+my_vector<T, K, A>::back() const
 {
+    return _array[_size - 1];
+}
+
+/* Unlike operator[], at() checks the index. */
+template<typename T, unsigned K, typename A>
+T&
+my_vector<T, K, A>::at(int i)
+{
+    if (i < 0 || (unsigned)i >= _size) {
+        throw std::out_of_range("my_vector::at: index out of range");
+    }
     return _array[i];
 }
 
-template<typename T>
-T
-my_vector<T>::operator[](int i) const
+template<typename T, unsigned K, typename A>
+const T&
+my_vector<T, K, A>::at(int i) const
+{
+    if (i < 0 || (unsigned)i >= _size) {
+        throw std::out_of_range("my_vector::at: index out of range");
+    }
+    return _array[i];
+}
+
+template<typename T, unsigned K, typename A>
+T&
+my_vector<T, K, A>::operator[](int i)
 {
     return _array[i];
 }
 
-template<typename T>
+template<typename T, unsigned K, typename A>
+const T&
+my_vector<T, K, A>::operator[](int i) const
+{
+    return _array[i];
+}
+
+template<typename T, unsigned K, typename A>
 void
-my_vector<T>::push_back(const T& item)
+my_vector<T, K, A>::push_back(const T& item)
 {
-    ++_size;
-    if (_capacity <= _size) {
-        increase_capacity();
+    emplace_back(item);
+}
+
+template<typename T, unsigned K, typename A>
+void
+my_vector<T, K, A>::push_back(T&& item)
+{
+    emplace_back(std::move(item));
+}
+
+/* When the array is full, the new element is built in the new storage
+ * before the old elements move, so 'args' may refer to one of them. */
+template<typename T, unsigned K, typename A>
+template<typename... Args>
+T&
+my_vector<T, K, A>::emplace_back(Args&&... args)
+{
+    if (_size == _capacity) {
+        unsigned new_capacity = _capacity ? _capacity << 1 : VECTOR_DEFAULT_SIZE;
+        T* new_array = allocate(new_capacity);
+        try {
+            new (new_array + _size) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(new_array, new_capacity);
+            throw;
+        }
+        try {
+            relocate(_array, _size, new_array);
+        } catch (...) {
+            new_array[_size].~T();
+            deallocate(new_array, new_capacity);
+            throw;
+        }
+        adopt(new_array, new_capacity);
+    } else {
+        new (_end) T(std::forward<Args>(args)...);
     }
-    *_end = item;
-    ++_end;
+    ++_size;
+    _end = _array + _size;
+    return _array[_size - 1];
 }
 
-template<typename T>
+template<typename T, unsigned K, typename A>
 void
-my_vector<T>::pop_back()
+my_vector<T, K, A>::pop_back()
 {
     if (_size > 0) {
         --_size;
         --_end;
+        _end->~T();
     }
 }
 
-template<typename T>
+template<typename T, unsigned K, typename A>
 void
-my_vector<T>::clear()
+my_vector<T, K, A>::clear()
 {
-    memset(_array, 0, _capacity * sizeof(T));
-    _size = 0;
-    _begin = _end = _array;
+    while (_size > 0) {
+        pop_back();
+    }
 }
 
-template<typename T>
+template<typename T, unsigned K, typename A>
+void
+my_vector<T, K, A>::reserve(unsigned capacity)
+{
+    if (capacity > _capacity) {
+        reallocate(capacity);
+    }
+}
+
+template<typename T, unsigned K, typename A>
+void
+my_vector<T, K, A>::resize(unsigned size)
+{
+    reserve(size);
+    while (_size > size) {
+        pop_back();
+    }
+    while (_size < size) {
+        emplace_back();
+    }
+}
+
+template<typename T, unsigned K, typename A>
+void
+my_vector<T, K, A>::resize(unsigned size, const T& value)
+{
+    /* 'value' may be one of the elements, which reserve() moves and
+     * pop_back() destroys, so fill with a copy of it */
+    const T fill(value);
+    reserve(size);
+    while (_size > size) {
+        pop_back();
+    }
+    while (_size < size) {
+        emplace_back(fill);
+    }
+}
+
+template<typename T, unsigned K, typename A>
 void
-my_vector<T>::print() const
+my_vector<T, K, A>::print() const
 {
     T *ptr = _begin;
     while (ptr != _end) {
@@ -149,39 +432,141 @@ my_vector<T>::print() const
     std::cout << "\n";
 }
 
-template<typename T>
+template<typename T, unsigned K, typename A>
 unsigned
-my_vector<T>::size() const
+my_vector<T, K, A>::size() const
 {
     return _size;
 }
 
-template<typename T>
+template<typename T, unsigned K, typename A>
+unsigned
+my_vector<T, K, A>::capacity() const
+{
+    return _capacity;
+}
+
+template<typename T, unsigned K, typename A>
 bool
-my_vector<T>::empty() const
+my_vector<T, K, A>::empty() const
 {
     return _size == 0;
 }
 
+/* True while the elements are stored inside the vector. */
+template<typename T, unsigned K, typename A>
+bool
+my_vector<T, K, A>::is_inline() const
+{
+    return _array == _inline.data();
+}
+
+template<typename T, unsigned K, typename A>
+A
+my_vector<T, K, A>::get_allocator() const
+{
+    return _alloc;
+}
+
 /*
  **************************
  **** Helper functions ****
  **************************
  */
-template<typename T>
+template<typename T, unsigned K, typename A>
 void
-my_vector<T>::increase_capacity()
+my_vector<T, K, A>::reallocate(unsigned new_capacity)
 {
-    unsigned new_capacity = _capacity << 1;
-    /* Allocate new array, copy data, and delete old one */
-    T* new_array = new T[new_capacity];
-    memcpy(new_array, _array, _capacity * sizeof(T));
-    delete [] _array;
+    /* Allocate new storage, move the elements over, and free the old one */
+    T* new_array = allocate(new_capacity);
+    try {
+        relocate(_array, _size, new_array);
+    } catch (...) {
+        deallocate(new_array, new_capacity);
+        throw;
+    }
+    adopt(new_array, new_capacity);
+}
+
+/* Frees the current heap storage, if any, and switches to 'new_array',
+ * which already holds the elements. */
+template<typename T, unsigned K, typename A>
+void
+my_vector<T, K, A>::adopt(T* new_array, unsigned new_capacity)
+{
+    release();
     _array = new_array;
     /* Set begin and end pointers appropriately */
     _begin = _array;
-    _end = &_array[_size - 1];
+    _end = _array + _size;
     _capacity = new_capacity;
 }
 
+/* Gives heap storage back to the allocator and goes back to the inline
+ * storage. The elements must have been destroyed or moved out. */
+template<typename T, unsigned K, typename A>
+void
+my_vector<T, K, A>::release()
+{
+    if (!is_inline()) {
+        deallocate(_array, _capacity);
+        _array = _begin = _end = _inline.data();
+        _capacity = K;
+    }
+}
+
+/* Room for 'capacity' elements, none of them constructed. */
+template<typename T, unsigned K, typename A>
+T*
+my_vector<T, K, A>::allocate(unsigned capacity)
+{
+    return traits::allocate(_alloc, capacity);
+}
+
+template<typename T, unsigned K, typename A>
+void
+my_vector<T, K, A>::deallocate(T* array, unsigned capacity)
+{
+    traits::deallocate(_alloc, array, capacity);
+}
+
+/* Moves from[0, n) into uninitialized storage at 'to', leaving 'from'
+ * as raw storage again. */
+template<typename T, unsigned K, typename A>
+void
+my_vector<T, K, A>::relocate(T* from, unsigned n, T* to)
+{
+    if (std::is_trivially_copyable<T>::value) {
+        if (n > 0) {
+            memcpy(static_cast<void*>(to), static_cast<const void*>(from),
+                   n * sizeof(T));
+        }
+        return;
+    }
+    if (std::is_nothrow_move_constructible<T>::value) {
+        /* Nothing can throw, so each element is destroyed as soon as it
+         * has moved, while it is still in cache */
+        for (unsigned i = 0; i < n; ++i) {
+            new (to + i) T(std::move(from[i]));
+            from[i].~T();
+        }
+        return;
+    }
+    unsigned i = 0;
+    try {
+        for (; i < n; ++i) {
+            new (to + i) T(std::move_if_noexcept(from[i]));
+        }
+    } catch (...) {
+        /* Only a copy can throw, so 'from' is still whole */
+        while (i > 0) {
+            to[--i].~T();
+        }
+        throw;
+    }
+    for (i = 0; i < n; ++i) {
+        from[i].~T();
+    }
+}
+
 #endif /* _MY_VECTOR_H_ */
@@ -1,5 +1,8 @@
 #include "my_vector.h"
+#include "../allocator/allocator.h"
 #include <iostream>
+#include <memory>
+#include <string>
 
 int
 main (const int argc, const char** argv)
@@ -16,5 +19,92 @@ main (const int argc, const char** argv)
     	v.print();
     }
 
+    /* Non-trivial elements survive growth, copies and moves */
+    bool ok = true;
+    my_vector<std::string> words;
+    for (unsigned i = 0; i < 100; ++i) {
+        words.push_back(std::string(i % 40, 'a' + i % 26));
+        words.push_back(words[0]);
+    }
+    my_vector<std::string> copy(words);
+    my_vector<std::string> moved(std::move(copy));
+    ok = ok && moved.size() == 200 && copy.size() == 0;
+    for (unsigned i = 0; i < 100; ++i) {
+        ok = ok && moved[2*i] == std::string(i % 40, 'a' + i % 26) &&
+             moved[2*i + 1] == words[0];
+    }
+    copy = moved;
+    moved.resize(5);
+    moved.resize(7);
+    moved.resize(8, "x");
+    ok = ok && copy.size() == 200 && moved.size() == 8 && moved[4] == words[4] &&
+         moved[5].empty() && moved.back() == "x";
+    /* The fill value may be an element that growing moves away */
+    my_vector<std::string> filled;
+    filled.push_back(words[2]);
+    filled.push_back(words[4]);
+    unsigned grown = 20*filled.capacity();
+    filled.resize(grown, filled[1]);
+    ok = ok && filled.size() == grown && filled[0] == words[2] &&
+         filled[2] == words[4] && filled.back() == words[4];
+
+    /* Move-only elements, reserve() and at() */
+    my_vector<std::unique_ptr<int> > owners;
+    owners.reserve(3);
+    ok = ok && owners.capacity() >= 3;
+    for (int i = 0; i < 50; ++i) {
+        owners.emplace_back(new int(i));
+    }
+    std::unique_ptr<int> last(new int(50));
+    owners.push_back(std::move(last));
+    for (int i = 0; i <= 50; ++i) {
+        ok = ok && *owners.at(i) == i;
+    }
+    try {
+        owners.at(51);
+        ok = false;
+    } catch (const std::out_of_range&) {
+    }
+
+    /* Inline storage holds K elements, then spills to the heap */
+    my_vector<std::string, 4> small;
+    for (unsigned i = 0; i < 4; ++i) {
+        small.push_back(words[2*i]);
+    }
+    ok = ok && small.is_inline() && small.capacity() == 4;
+    my_vector<std::string, 4> small_moved(std::move(small));
+    ok = ok && small_moved.is_inline() && small_moved.size() == 4 &&
+         small_moved[3] == words[6] && small.empty();
+    small = small_moved;
+    small.push_back(small[0]);
+    ok = ok && !small.is_inline() && small.size() == 5 && small[4] == words[0];
+    small_moved = std::move(small);
+    ok = ok && !small_moved.is_inline() && small_moved.size() == 5 &&
+         small.is_inline() && small.empty();
+
+    /* Spill storage from an arena; nothing is allocated until it spills */
+    typedef arena_allocator<int, 1 << 16> arena_alloc;
+    allocator<1 << 16> arena, other_arena;
+    {
+        my_vector<int, 8, arena_alloc> numbers((arena_alloc(arena)));
+        for (int i = 0; i < 8; ++i) {
+            numbers.push_back(i);
+        }
+        ok = ok && arena.stats().allocations == 0;
+        for (int i = 8; i < 100; ++i) {
+            numbers.push_back(i);
+        }
+        ok = ok && arena.stats().allocations > 0 && !numbers.is_inline();
+        /* Different arenas: the elements are moved, not the storage */
+        my_vector<int, 8, arena_alloc> others((arena_alloc(other_arena)));
+        others = std::move(numbers);
+        ok = ok && others.size() == 100 && others[99] == 99 &&
+             other_arena.stats().live_blocks == 1 &&
+             arena.stats().live_blocks == 1;
+    }
+    ok = ok && arena.stats().live_blocks == 0 &&
+         other_arena.stats().live_blocks == 0;
+    std::cout << (ok ? "Test passed." : "Something went wrong...") << "\n";
+
     return 0;
 }